@@ -14,6 +14,7 @@
 
 #include <string.h>
 #include <ctype.h>
+#include <limits.h>
 
 #include "debug.h"
 #include "keyword.h"
@@ -27,16 +28,27 @@
 typedef struct sHashEntry {
 	struct sHashEntry *next;
 	const char *string;
+	size_t length;
 	langType language;
 	int value;
 } hashEntry;
 
+/* Summary of the keywords of one language, used to reject most identifiers
+ * without hashing them */
+typedef struct sKeywordFilter {
+	unsigned int count;
+	size_t minLen;
+	size_t maxLen;
+	unsigned char firstChars [(UCHAR_MAX + 1) / CHAR_BIT];
+} keywordFilter;
+
 /*
 *   DATA DEFINITIONS
 */
 static const unsigned int TableSize = 2039;  /* prime */
 static hashEntry **HashTable = NULL;
-static unsigned int MaxEntryLen = 0;
+static keywordFilter *Filters = NULL;
+static unsigned int FilterCount = 0;
 
 /*
 *   FUNCTION DEFINITIONS
@@ -71,8 +83,55 @@ static hashEntry *getHashTableEntry (unsigned long hashedValue)
 	return entry;
 }
 
-static unsigned int hashValue (const char *const string, langType language,
-	unsigned int maxLen, bool *maxLenReached)
+static keywordFilter *getKeywordFilter (langType language, bool create)
+{
+	if (language < 0)
+		return NULL;
+
+	if ((unsigned int) language >= FilterCount)
+	{
+		const unsigned int count = language + 1;
+
+		if (! create)
+			return NULL;
+
+		Filters = xRealloc (Filters, count, keywordFilter);
+		memset (Filters + FilterCount, 0, (count - FilterCount) * sizeof (keywordFilter));
+		FilterCount = count;
+	}
+	return Filters + language;
+}
+
+static void setFirstChar (keywordFilter *filter, unsigned char c)
+{
+	filter->firstChars [c / CHAR_BIT] |= 1 << (c % CHAR_BIT);
+}
+
+static bool hasFirstChar (const keywordFilter *filter, unsigned char c)
+{
+	return (filter->firstChars [c / CHAR_BIT] & (1 << (c % CHAR_BIT))) != 0;
+}
+
+static void updateKeywordFilter (langType language, const char *const string, size_t length)
+{
+	keywordFilter *filter = getKeywordFilter (language, true);
+	const unsigned char c = (unsigned char) string [0];
+
+	if (filter->count++ == 0 || length < filter->minLen)
+		filter->minLen = length;
+	if (length > filter->maxLen)
+		filter->maxLen = length;
+
+	/* both cases, for lookupCaseKeyword() */
+	setFirstChar (filter, c);
+	setFirstChar (filter, (unsigned char) tolower (c));
+	setFirstChar (filter, (unsigned char) toupper (c));
+}
+
+/* Returns false if STRING is longer than MAXLEN; otherwise stores its hash
+ * in HASH and its length in LENGTH */
+static bool hashValue (const char *const string, langType language,
+	size_t maxLen, unsigned int *hash, size_t *length)
 {
 	const char *p;
 	unsigned int h = 5381;
@@ -82,29 +141,28 @@ static unsigned int hashValue (const char *const string, langType language,
 	/* "djb" hash as used in g_str_hash() in glib */
 	for (p = string; *p != '\0'; p++)
 	{
-		h = (h << 5) + h + (signed char) tolower ((unsigned char) *p);
+		if ((size_t) (p - string) >= maxLen)
+			return false;
 
-		if (p > string + maxLen)
-		{
-			*maxLenReached = true;
-			return 0;
-		}
+		h = (h << 5) + h + (signed char) tolower ((unsigned char) *p);
 	}
 
 	/* consider language as an extra "character" and add it to the hash */
 	h = (h << 5) + h + language;
 
-	*maxLenReached = false;
-	return h;
+	*hash = h;
+	*length = p - string;
+	return true;
 }
 
 static hashEntry *newEntry (
-		const char *const string, langType language, int value)
+		const char *const string, size_t length, langType language, int value)
 {
 	hashEntry *const entry = xMalloc (1, hashEntry);
 
 	entry->next     = NULL;
 	entry->string   = string;
+	entry->length   = length;
 	entry->language = language;
 	entry->value    = value;
 
@@ -118,18 +176,21 @@ static hashEntry *newEntry (
  */
 extern void addKeyword (const char *const string, langType language, int value)
 {
-	bool dummy;
-	const unsigned int index = hashValue (string, language, 1000, &dummy) % TableSize;
-	hashEntry *entry = getHashTableEntry (index);
-	size_t len = strlen (string);
+	unsigned int hash;
+	size_t len;
+	unsigned int index;
+	hashEntry *entry;
 
-	if (len > MaxEntryLen)
-		MaxEntryLen = len;
+	hashValue (string, language, (size_t) -1, &hash, &len);
+	index = hash % TableSize;
+	entry = getHashTableEntry (index);
+
+	updateKeywordFilter (language, string, len);
 
 	if (entry == NULL)
 	{
 		hashEntry **const table = getHashTable ();
-		table [index] = newEntry (string, language, value);
+		table [index] = newEntry (string, len, language, value);
 	}
 	else
 	{
@@ -148,27 +209,35 @@ extern void addKeyword (const char *const string, langType language, int value)
 		if (entry == NULL)
 		{
 			Assert (prev != NULL);
-			prev->next = newEntry (string, language, value);
+			prev->next = newEntry (string, len, language, value);
 		}
 	}
 }
 
 static int lookupKeywordFull (const char *const string, bool caseSensitive, langType language)
 {
-	bool maxLenReached;
-	const unsigned int index = hashValue (string, language, MaxEntryLen, &maxLenReached) % TableSize;
+	const keywordFilter *filter = getKeywordFilter (language, false);
+	unsigned int hash;
+	size_t len;
 	hashEntry *entry;
 	int result = KEYWORD_NONE;
 
-	if (maxLenReached)
+	/* Most identifiers are not keywords: reject them cheaply when they
+	 * cannot be one because of their first character or their length */
+	if (filter == NULL || filter->count == 0 ||
+		! hasFirstChar (filter, (unsigned char) string [0]))
 		return KEYWORD_NONE;
 
-	entry = getHashTableEntry (index);
+	if (! hashValue (string, language, filter->maxLen, &hash, &len) ||
+		len < filter->minLen)
+		return KEYWORD_NONE;
+
+	entry = getHashTableEntry (hash % TableSize);
 
 	while (entry != NULL)
 	{
-		if (language == entry->language &&
-			((caseSensitive && strcmp (string, entry->string) == 0) ||
+		if (len == entry->length && language == entry->language &&
+			((caseSensitive && memcmp (string, entry->string, len) == 0) ||
 			 (!caseSensitive && strcasecmp (string, entry->string) == 0)))
 		{
 			result = entry->value;
@@ -208,6 +277,13 @@ extern void freeKeywordTable (void)
 		}
 		eFree (HashTable);
 	}
+
+	if (Filters != NULL)
+	{
+		eFree (Filters);
+		Filters = NULL;
+		FilterCount = 0;
+	}
 }
 
 #ifdef DEBUG
@@ -24,7 +24,10 @@
 
 #include "lregex_p.h"
 #include "trashbox.h"
+#include "vstring.h"
 
+#include <ctype.h>
+#include <regex.h>
 #include <string.h>
 
 /*
@@ -101,6 +104,176 @@ static regexCompiledCode compile (struct regexBackend *backend,
 			   buffer);
 		return (regexCompiledCode) { .backend = NULL, .code = NULL };
 	}
+	/* pcre2_match() uses the JIT code when there is some; without JIT
+	 * support this fails and matching stays interpreted. */
+	pcre2_jit_compile (regex_code, PCRE2_JIT_COMPLETE);
+	return (regexCompiledCode) { .backend = &pcre2RegexBackend, .code = regex_code };
+}
+
+/* Rewrites a POSIX extended regular expression in PCRE2 syntax. Returns
+ * NULL when the pattern uses something whose match could differ between
+ * the engines. POSIX picks the longest match and then the longest
+ * subexpressions, while PCRE2 backtracks and takes the first match in
+ * its search order. The translation is limited to patterns where no early
+ * choice can change the extent of the match or of a group:
+ * - no alternation and no back-references,
+ * - quantifiers only on single-character atoms (a character, ".", an
+ *   escape or a bracket expression), never on a group and never stacked
+ *   ("*?" is lazy in PCRE2 but a repeated quantifier in POSIX).
+ * Groups without a quantifier only record positions then. */
+static char *translatePosixExtended (const char *regexp, bool newline)
+{
+	vString *out = vStringNew ();
+	const char *p = regexp;
+	/* whether the last token is an atom a quantifier may follow */
+	bool atom = false;
+
+	while (*p)
+	{
+		if (*p == '\\')
+		{
+			const char c = p[1];
+
+			atom = false;
+			switch (c)
+			{
+				case 'w': case 'W': case 's': case 'S':
+					vStringPut (out, '\\');
+					vStringPut (out, c);
+					atom = true;
+					break;
+				case 'b': case 'B':
+					vStringPut (out, '\\');
+					vStringPut (out, c);
+					break;
+				case '<':	vStringCatS (out, "\\b(?=\\w)");	break;
+				case '>':	vStringCatS (out, "\\b(?<=\\w)");	break;
+				case '`':	vStringCatS (out, "\\A");	break;
+				case '\'':	vStringCatS (out, "\\z");	break;
+				default:
+					/* back-references, unknown escapes */
+					if (c == '\0' || isalnum ((unsigned char) c))
+						goto incompatible;
+					/* escaped punctuation is literal in both syntaxes */
+					vStringPut (out, '\\');
+					vStringPut (out, c);
+					atom = true;
+					break;
+			}
+			p += 2;
+		}
+		else if (*p == '[')
+		{
+			vStringPut (out, *p++);
+			if (*p == '^')
+			{
+				vStringPut (out, *p++);
+				/* REG_NEWLINE: a non-matching list never matches a newline */
+				if (newline)
+					vStringCatS (out, "\\n");
+			}
+			if (*p == ']')
+			{
+				vStringCatS (out, "\\]");
+				p++;
+			}
+			while (*p && *p != ']')
+			{
+				if (*p == '[' && p[1] == ':')
+				{
+					const char *end = strstr (p + 2, ":]");
+
+					if (!end)
+						goto incompatible;
+					vStringNCatS (out, p, end + 2 - p);
+					p = end + 2;
+				}
+				else if (*p == '[' && (p[1] == '.' || p[1] == '='))
+					goto incompatible;	/* collating symbols, equivalence classes */
+				else if (*p == '\\')
+				{
+					/* backslash is not special inside a bracket expression */
+					vStringCatS (out, "\\\\");
+					p++;
+				}
+				else
+					vStringPut (out, *p++);
+			}
+			if (*p != ']')
+				goto incompatible;
+			vStringPut (out, *p++);
+			atom = true;
+		}
+		else if (*p == '*' || *p == '+' || *p == '?' || *p == '{')
+		{
+			if (!atom)
+				goto incompatible;
+			if (*p == '{')
+			{
+				const char *end = strchr (p, '}');
+
+				if (!end)
+					goto incompatible;
+				/* GNU accepts {,N}, older PCRE2 versions take it literally */
+				if (p[1] == ',')
+				{
+					vStringCatS (out, "{0");
+					p++;
+				}
+				vStringNCatS (out, p, end + 1 - p);
+				p = end + 1;
+			}
+			else
+				vStringPut (out, *p++);
+			atom = false;
+		}
+		else if (*p == '|' || (*p == '(' && p[1] == '?'))
+			goto incompatible;
+		else
+		{
+			atom = (*p != '(' && *p != ')' && *p != '^' && *p != '$');
+			vStringPut (out, *p++);
+		}
+	}
+
+	return vStringDeleteUnwrap (out);
+
+incompatible:
+	vStringDelete (out);
+	return NULL;
+}
+
+extern regexCompiledCode pcre2_compile_posix_extended (const char *const regexp, int flags)
+{
+	int errornumber;
+	PCRE2_SIZE erroroffset;
+	uint32_t options = 0;
+	pcre2_code *regex_code;
+	char *translated;
+
+	if (!(flags & REG_EXTENDED))
+		return (regexCompiledCode) { .backend = NULL, .code = NULL };
+
+	translated = translatePosixExtended (regexp, (flags & REG_NEWLINE) != 0);
+	if (!translated)
+		return (regexCompiledCode) { .backend = NULL, .code = NULL };
+
+	if (flags & REG_ICASE)
+		options |= PCRE2_CASELESS;
+	if (flags & REG_NEWLINE)
+		options |= PCRE2_MULTILINE;
+	else
+		options |= PCRE2_DOTALL | PCRE2_DOLLAR_ENDONLY;
+
+	regex_code = pcre2_compile ((PCRE2_SPTR)translated, PCRE2_ZERO_TERMINATED,
+								options, &errornumber, &erroroffset, NULL);
+	eFree (translated);
+
+	/* no warning: the caller falls back to the default backend */
+	if (regex_code == NULL)
+		return (regexCompiledCode) { .backend = NULL, .code = NULL };
+
+	pcre2_jit_compile (regex_code, PCRE2_JIT_COMPLETE);
 	return (regexCompiledCode) { .backend = &pcre2RegexBackend, .code = regex_code };
 }
 
@@ -138,8 +138,23 @@ struct mTableActionSpec {
 	struct regexTable *continuation_table;
 };
 
+/* A literal string every match of a single line pattern contains.
+ * Lines not containing it are rejected without running the regex engine. */
+struct regexPrefilter {
+	char *literal;				/* NULL if the pattern has no usable literal */
+	size_t length;
+	uint64_t bytes[4];			/* the set of bytes in literal */
+};
+
+/* the set of bytes in the line being matched, computed on first use */
+struct lineBytes {
+	bool ready;
+	uint64_t bytes[4];
+};
+
 typedef struct {
 	regexCompiledCode pattern;
+	struct regexPrefilter prefilter;
 	enum pType type;
 	bool exclusive;
 	bool accept_empty_name;
@@ -331,6 +346,9 @@ static void deletePattern (regexPattern *p)
 
 	p->pattern.backend->delete_code (p->pattern.code);
 
+	if (p->prefilter.literal)
+		eFree (p->prefilter.literal);
+
 	if (p->type == PTRN_TAG)
 	{
 		eFree (p->u.tag.name_pattern);
@@ -1573,8 +1591,188 @@ static struct flagDefsDescriptor choose_backend (const char *flags, enum regexPa
 	return desc;
 }
 
+/* Skips a bracket expression, P pointing after its opening '['.
+ * Returns a pointer after the closing ']', or NULL if there is none. */
+static const char *skipBracketExpression (const char *p)
+{
+	if (*p == '^')
+		p++;
+	if (*p == ']')
+		p++;
+	while (*p != '\0' && *p != ']')
+	{
+		if (*p == '[' && (p[1] == ':' || p[1] == '.' || p[1] == '='))
+		{
+			char delim = p[1];
+
+			p += 2;
+			while (*p != '\0' && !(*p == delim && p[1] == ']'))
+				p++;
+			if (*p == '\0')
+				return NULL;
+			p += 2;
+		}
+		else
+			p++;
+	}
+	return (*p == ']')? p + 1: NULL;
+}
+
+static void commitLiteralRun (vString *run, vString *best)
+{
+	if (vStringLength (run) > vStringLength (best))
+		vStringCopy (best, run);
+	vStringClear (run);
+}
+
+/* Finds the longest literal string any match of a POSIX (GNU) regex contains.
+ * Only literals outside of groups are considered, and any construct the scan
+ * doesn't understand with certainty just ends the current literal, so that
+ * the result is never wrong, only sometimes shorter than it could be.
+ * Returns false for patterns with alternatives. */
+static bool findRequiredLiteral (const char *regexp, bool extended, vString *best)
+{
+	vString *run = vStringNew ();
+	const char *p = regexp;
+	int depth = 0;
+	bool ok = true;
+
+	while (ok && *p != '\0')
+	{
+		enum { ATOM, LITERAL, QUANTIFIER, INTERVAL, GROUP_OPEN, GROUP_CLOSE, ALTERNATION } what = ATOM;
+		unsigned char c = *p++;
+
+		if (c == '\\')
+		{
+			c = *p++;
+			if (c == '\0')
+				ok = false;
+			else if (strchr (extended? ".[]{}()*+?^$|\\/": ".[]*^$\\/", c))
+				what = LITERAL;
+			else if (!extended && c == '(')
+				what = GROUP_OPEN;
+			else if (!extended && c == ')')
+				what = GROUP_CLOSE;
+			else if (!extended && c == '{')
+				what = INTERVAL;
+			else if (!extended && (c == '+' || c == '?'))
+				what = QUANTIFIER;
+			else if (!extended && c == '|')
+				what = ALTERNATION;
+			/* other escapes (\w, \<, \1...) are not literals */
+		}
+		else if (c == '[')
+		{
+			p = skipBracketExpression (p);
+			ok = (p != NULL);
+		}
+		else if (c == '*' || (extended && (c == '+' || c == '?')))
+			what = QUANTIFIER;
+		else if (extended && c == '{')
+			what = INTERVAL;
+		else if (extended && c == '(')
+			what = GROUP_OPEN;
+		else if (extended && c == ')')
+			what = GROUP_CLOSE;
+		else if (extended && c == '|')
+			what = ALTERNATION;
+		else if (c != '.' && c != '^' && c != '$' && c < 0x80)
+			what = LITERAL;
+		/* a non-ASCII byte may be part of a multibyte character */
+
+		if (!ok)
+			break;
+
+		switch (what)
+		{
+			case LITERAL:
+				if (depth == 0)
+				{
+					vStringPut (run, c);
+					break;
+				}
+				/* Fall through */
+			case ATOM:
+				commitLiteralRun (run, best);
+				break;
+			case INTERVAL:
+				p = strstr (p, extended? "}": "\\}");
+				ok = (p != NULL);
+				if (ok)
+					p += extended? 1: 2;
+				/* Fall through */
+			case QUANTIFIER:
+				/* the atom before might not be matched at all */
+				if (vStringLength (run) > 0)
+					vStringTruncate (run, vStringLength (run) - 1);
+				commitLiteralRun (run, best);
+				break;
+			case GROUP_OPEN:
+				commitLiteralRun (run, best);
+				depth++;
+				break;
+			case GROUP_CLOSE:
+				commitLiteralRun (run, best);
+				depth--;
+				break;
+			case ALTERNATION:
+				ok = false;
+				break;
+		}
+	}
+	commitLiteralRun (run, best);
+	vStringDelete (run);
+
+	return ok && vStringLength (best) > 0;
+}
+
+static void buildPrefilter (struct regexPrefilter *prefilter, const char *regexp, int flags)
+{
+	vString *literal = vStringNew ();
+
+	/* with REG_ICASE, the case folding rules of the locale would apply */
+	if (!(flags & REG_ICASE)
+		&& findRequiredLiteral (regexp, (flags & REG_EXTENDED), literal))
+	{
+		prefilter->length = vStringLength (literal);
+		prefilter->literal = vStringDeleteUnwrap (literal);
+		memset (prefilter->bytes, 0, sizeof prefilter->bytes);
+		for (size_t i = 0; i < prefilter->length; i++)
+		{
+			unsigned char c = prefilter->literal[i];
+			prefilter->bytes[c / 64] |= UINT64_C(1) << (c % 64);
+		}
+	}
+	else
+		vStringDelete (literal);
+}
+
+static bool prefilterAccepts (const struct regexPrefilter *prefilter,
+							  const vString *const line, struct lineBytes *lineBytes)
+{
+	if (!lineBytes->ready)
+	{
+		memset (lineBytes->bytes, 0, sizeof lineBytes->bytes);
+		for (size_t i = 0; i < vStringLength (line); i++)
+		{
+			unsigned char c = vStringChar (line, i);
+			lineBytes->bytes[c / 64] |= UINT64_C(1) << (c % 64);
+		}
+		lineBytes->ready = true;
+	}
+
+	for (unsigned int i = 0; i < ARRAY_SIZE (prefilter->bytes); i++)
+	{
+		if (prefilter->bytes[i] & ~lineBytes->bytes[i])
+			return false;
+	}
+	/* regexec() stops at the first NUL as strstr() does */
+	return strstr (vStringValue (line), prefilter->literal) != NULL;
+}
+
 static regexCompiledCode compileRegex (enum regexParserType regptype,
-									   const char* const regexp, const char* const flags)
+									   const char* const regexp, const char* const flags,
+									   struct regexPrefilter *prefilter)
 {
 	struct flagDefsDescriptor desc = choose_backend (flags, regptype, false);
 
@@ -1589,7 +1787,23 @@ static regexCompiledCode compileRegex (enum regexParserType regptype,
 			   ARRAY_SIZE (backendCommonRegexFlagDefs),
 			   &desc);
 
-	return desc.backend->compile (desc.backend, regexp, desc.flags);
+	const bool posix = (strcmp (desc.backend->name, "default") == 0);
+	regexCompiledCode cp = { .backend = NULL, .code = NULL };
+
+#ifdef HAVE_PCRE2
+	/* Run POSIX patterns on the JIT-compiled PCRE2 engine when they can be
+	 * expressed there without changing what they match */
+	if (posix)
+		cp = pcre2_compile_posix_extended (regexp, desc.flags);
+#endif
+	if (cp.code == NULL)
+		cp = desc.backend->compile (desc.backend, regexp, desc.flags);
+
+	/* the literal scan only knows the syntax of the default backend */
+	if (prefilter && cp.code && regptype == REG_PARSER_SINGLE_LINE && posix)
+		buildPrefilter (prefilter, regexp, desc.flags);
+
+	return cp;
 }
 
 
@@ -1997,6 +2211,7 @@ static bool fillGuestRequest (const char *start,
 
 static bool matchRegexPattern (struct lregexControlBlock *lcb,
 							   const vString* const line,
+							   struct lineBytes *lineBytes,
 							   regexTableEntry *entry)
 {
 	bool result = false;
@@ -2008,10 +2223,13 @@ static bool matchRegexPattern (struct lregexControlBlock *lcb,
 	if (patbuf->disabled && *(patbuf->disabled))
 		return false;
 
-	match = patbuf->pattern.backend->match (patbuf->pattern.backend,
-											patbuf->pattern.code, vStringValue (line),
-											vStringLength (line),
-											pmatch);
+	if (patbuf->prefilter.literal && !prefilterAccepts (&patbuf->prefilter, line, lineBytes))
+		match = REG_NOMATCH;
+	else
+		match = patbuf->pattern.backend->match (patbuf->pattern.backend,
+												patbuf->pattern.code, vStringValue (line),
+												vStringLength (line),
+												pmatch);
 
 	if (match == 0)
 	{
@@ -2198,6 +2416,7 @@ extern bool regexIsPostRun (struct lregexControlBlock *lcb)
 extern bool matchRegex (struct lregexControlBlock *lcb, const vString* const line, bool postrun)
 {
 	bool result = false;
+	struct lineBytes lineBytes = { .ready = false };
 	unsigned int i;
 	for (i = 0  ;  i < ptrArrayCount(lcb->entries[REG_PARSER_SINGLE_LINE])  ;  ++i)
 	{
@@ -2213,7 +2432,7 @@ extern bool matchRegex (struct lregexControlBlock *lcb, const vString* const lin
 			&& (!isXtagEnabled (ptrn->xtagType)))
 				continue;
 
-		if (matchRegexPattern (lcb, line, entry))
+		if (matchRegexPattern (lcb, line, &lineBytes, entry))
 		{
 			result = true;
 			if (ptrn->exclusive)
@@ -2354,7 +2573,8 @@ static regexPattern *addTagRegexInternal (struct lregexControlBlock *lcb,
 	if (!regexAvailable)
 		return NULL;
 
-	regexCompiledCode cp = compileRegex (regptype, regex, flags);
+	struct regexPrefilter prefilter = { .literal = NULL };
+	regexCompiledCode cp = compileRegex (regptype, regex, flags, &prefilter);
 	if (cp.code == NULL)
 	{
 		error (WARNING, "pattern: %s", regex);
@@ -2441,6 +2661,7 @@ static regexPattern *addTagRegexInternal (struct lregexControlBlock *lcb,
 												kindLetter, kindName, description, flags,
 												explictly_defined,
 												disabled);
+	rptr->prefilter = prefilter;
 	rptr->pattern_string = escapeRegexPattern(regex);
 
 	eFree (kindName);
@@ -2521,7 +2742,8 @@ extern void addCallbackRegex (struct lregexControlBlock *lcb,
 		return;
 
 
-	regexCompiledCode cp = compileRegex (REG_PARSER_SINGLE_LINE, regex, flags);
+	struct regexPrefilter prefilter = { .literal = NULL };
+	regexCompiledCode cp = compileRegex (REG_PARSER_SINGLE_LINE, regex, flags, &prefilter);
 	if (cp.code == NULL)
 	{
 		error (WARNING, "pattern: %s", regex);
@@ -2531,6 +2753,7 @@ extern void addCallbackRegex (struct lregexControlBlock *lcb,
 
 	regexPattern *rptr = addCompiledCallbackPattern (lcb, &cp, callback, flags,
 													 disabled, userData);
+	rptr->prefilter = prefilter;
 	rptr->pattern_string = escapeRegexPattern(regex);
 }
 
@@ -130,6 +130,7 @@ extern void extend_regex_flag_long (const char* const s, const char* const unuse
 #ifdef HAVE_PCRE2
 extern void pcre2_regex_flag_short (char c, void* data);
 extern void pcre2_regex_flag_long (const char* const s, const char* const unused, void* data);
+extern regexCompiledCode pcre2_compile_posix_extended (const char *const regexp, int flags);
 #endif
 
 #endif	/* CTAGS_MAIN_LREGEX_PRIVATEH */
@@ -989,6 +989,47 @@ char *mio_gets (MIO *mio, char *s, size_t size)
 	}
 }
 
+/**
+ * mio_memory_get_line:
+ * @mio: A #MIO object
+ * @length: Return location for the length of the line
+ *
+ * Reads a line from a #MIO memory stream without copying it, like mio_gets()
+ * would do it. The returned line is a part of the underlying memory buffer,
+ * it ends with a new-line character unless it is the last line of the stream,
+ * and it is not NUL-terminated.
+ *
+ * Nothing is read if the stream is not a memory stream, if a character was
+ * pushed back with mio_ungetc(), or if the line contains a NUL byte (which
+ * mio_gets() callers can't see past).
+ *
+ * Returns: The line, or %NULL if the line could not be borrowed.
+ *          At the end of the stream, a valid pointer is returned and @length
+ *          is set to 0.
+ */
+const unsigned char *mio_memory_get_line (MIO *mio, size_t *length)
+{
+	const unsigned char *line, *end;
+	size_t avail;
+
+	if (mio->type != MIO_TYPE_MEMORY || mio->impl.mem.ungetch != EOF)
+		return NULL;
+
+	line = mio->impl.mem.buf + mio->impl.mem.pos;
+	avail = (mio->impl.mem.pos < mio->impl.mem.size)
+		? mio->impl.mem.size - mio->impl.mem.pos : 0;
+	end = memchr (line, '\n', avail);
+	*length = end ? (size_t) (end - line) + 1 : avail;
+
+	if (memchr (line, '\0', *length) != NULL)
+		return NULL;
+
+	mio->impl.mem.pos += *length;
+	if (!end)
+		mio->impl.mem.eof = true;
+	return line;
+}
+
 /**
  * mio_clearerr:
  * @mio: A #MIO object
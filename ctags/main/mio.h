@@ -144,6 +144,7 @@ size_t mio_write (MIO *mio,
 				  size_t nmemb);
 int mio_getc (MIO *mio);
 char *mio_gets (MIO *mio, char *s, size_t size);
+const unsigned char *mio_memory_get_line (MIO *mio, size_t *length);
 int mio_ungetc (MIO *mio, int ch);
 int mio_putc (MIO *mio, int c);
 int mio_puts (MIO *mio, const char *s);
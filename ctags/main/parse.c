@@ -94,6 +94,7 @@ typedef struct sParserObject {
 										  is emitted or not. */
 	unsigned int justRunForSchedulingBase:1;
 	unsigned int used;			/* Used for printing language specific statistics. */
+	unsigned int rescans;		/* Number of rescans of the last input file. */
 
 	unsigned int anonymousIdentiferId; /* managed by anon* functions */
 
@@ -4485,6 +4486,12 @@ extern void printParserStatisticsIfUsed (langType language)
 	}
 }
 
+/* Returns how many times the parser had to rescan the last file it parsed. */
+extern unsigned int getLanguageRescanCount (const langType language)
+{
+	return LanguageTable [language].rescans;
+}
+
 static bool createTagsWithFallback1 (const langType language,
 									 langType *exclusive_subparser)
 {
@@ -4516,11 +4523,14 @@ static bool createTagsWithFallback1 (const langType language,
 
 	anonResetMaybe (parser);
 	parser->justRunForSchedulingBase = 0;
+	parser->rescans = 0;
 
 	while ( ( whyRescan =
 		  createTagsForFile (language, ++passCount) )
 		!= RESCAN_NONE)
 	{
+		parser->rescans++;
+
 		if (useCork)
 		{
 			uncorkTagFile();
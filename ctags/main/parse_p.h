@@ -198,6 +198,7 @@ extern bool makeParserVersionPseudoTags (const langType language,
 
 extern void printLanguageMultitableStatistics (langType language);
 extern void printParserStatisticsIfUsed (langType lang);
+extern unsigned int getLanguageRescanCount (const langType language);
 
 /* For keeping the API compatibility with Geany, we use a macro here. */
 #define applyLanguageParam applyParameter
@@ -1113,12 +1113,29 @@ typedef enum eEolType {
 
 static eolType readLine (vString *const vLine, MIO *const mio)
 {
+	const unsigned char *line;
 	char *str;
 	size_t size;
 	eolType r = eol_nl;
 
 	vStringClear (vLine);
 
+	line = mio_memory_get_line (mio, &size);
+	if (line)
+	{
+		/* a single copy instead of the byte by byte one of mio_gets() */
+		vStringNCatSUnsafe (vLine, (const char *) line, size);
+		if (size == 0 || vStringLast (vLine) != '\n')
+			r = eol_eof;
+		else if (size > 1 && vStringChar (vLine, size - 2) == '\r')
+		{
+			vStringChar (vLine, size - 2) = '\n';
+			vStringChop (vLine);
+			r = eol_cr_nl;
+		}
+		return r;
+	}
+
 	str = vStringValue (vLine);
 	size = vStringSize (vLine);
 
@@ -124,6 +124,9 @@ typedef struct sCppState {
 
 	ungetBuffer  *ungetBuffer;
 	ptrArray *ungetBufferStack;
+	/* a drained unget buffer kept for the next unget, most ungets are of a
+	   single character right after it was read */
+	ungetBuffer  *ungetBufferSpare;
 
 	/* the contents of the last SYMBOL_CHAR or SYMBOL_STRING */
 	vString * charOrStringContents;
@@ -252,6 +255,11 @@ static int externalParserBlockNestLevel;
  */
 static bool BraceFormat = false;
 
+/*  Set when a branch decision was taken which would have been different
+ *  with brace formatting, i.e. if a rescan of the input could differ.
+ */
+static bool BraceFormatDependent = false;
+
 extern void cppPushExternalParserBlock(void)
 {
 	externalParserBlockNestLevel++;
@@ -268,6 +276,7 @@ static cppState Cpp = {
 	.clientLang = LANG_IGNORE,
 	.ungetBuffer = NULL,
 	.ungetBufferStack = NULL,
+	.ungetBufferSpare = NULL,
 	.charOrStringContents = NULL,
 	.resolveRequired = false,
 	.hasAtLiteralStrings = false,
@@ -318,6 +327,15 @@ extern bool cppIsBraceFormat (void)
 	return BraceFormat;
 }
 
+/*  Returns whether a rescan with brace formatting could give a different
+ *  result. If it is false, the rescan would take exactly the same branches
+ *  as the current scan and fail the same way, so the client can skip it.
+ */
+extern bool cppIsBraceFormatDependent (void)
+{
+	return BraceFormatDependent;
+}
+
 extern unsigned int cppGetDirectiveNestLevel (void)
 {
 	return Cpp.directive.nestLevel;
@@ -327,7 +345,12 @@ static ungetBuffer *ungetBufferNew  (unsigned long lineNumber,
 									 MIOPos filePosition,
 									 cppMacroInfo *macro)
 {
-	ungetBuffer *ub = xCalloc (1, ungetBuffer);
+	ungetBuffer *ub = Cpp.ungetBufferSpare;
+
+	if (ub)
+		Cpp.ungetBufferSpare = NULL;
+	else
+		ub = xCalloc (1, ungetBuffer);
 	ub->lineNumber = lineNumber;
 	ub->filePosition = filePosition;
 	ub->macro = macro;
@@ -348,6 +371,23 @@ static void ungetBufferDelete (ungetBuffer *ub)
 	eFree (ub);
 }
 
+/* Keeps a drained buffer for ungetBufferNew() unless there is one already.
+ * Only the initial small storage is kept so the size seen by
+ * cppUngetBufferSize() doesn't depend on earlier ungets. */
+static void ungetBufferRecycle (ungetBuffer *ub)
+{
+	if (Cpp.ungetBufferSpare || ub->size > 8)
+	{
+		ungetBufferDelete (ub);
+		return;
+	}
+
+	Assert (ub->dataSize == 0);
+	ub->pointer = NULL;
+	ub->macro = NULL;
+	Cpp.ungetBufferSpare = ub;
+}
+
 static void cppInitCommon(langType clientLang,
 		     const bool state, const bool hasAtLiteralStrings,
 		     const bool hasCxxRawLiteralStrings,
@@ -361,6 +401,7 @@ static void cppInitCommon(langType clientLang,
 		     int macrodefFieldIndex)
 {
 	BraceFormat = state;
+	BraceFormatDependent = false;
 
 	CXX_DEBUG_PRINT("cppInit: brace format is %d",BraceFormat);
 
@@ -497,6 +538,8 @@ extern void cppTerminate (void)
 
 	ungetBufferDelete (Cpp.ungetBuffer); /* NULL is acceptable */
 	Cpp.ungetBuffer = NULL;
+	ungetBufferDelete (Cpp.ungetBufferSpare);
+	Cpp.ungetBufferSpare = NULL;
 	ptrArrayDelete (Cpp.ungetBufferStack);
 	Cpp.ungetBufferStack = NULL;
 
@@ -753,7 +796,7 @@ static int cppGetcFromUngetBufferOrFile(void)
 		if (c != EOF)
 			return c;
 
-		ungetBufferDelete (Cpp.ungetBuffer);
+		ungetBufferRecycle (Cpp.ungetBuffer);
 		Cpp.ungetBuffer = NULL;
 		if (!ptrArrayIsEmpty (Cpp.ungetBufferStack))
 		{
@@ -884,6 +927,8 @@ static bool isIgnoreBranch (void)
 		)
 	{
 		CXX_DEBUG_PRINT("Choosing single branch");
+		if (!ifdef->singleBranch)
+			BraceFormatDependent = true;
 		ifdef->singleBranch = true;
 	}
 
@@ -904,9 +949,12 @@ static void chooseBranch (void)
 	if (! BraceFormat)
 	{
 		conditionalInfo *const ifdef = currentConditional ();
+		const bool branchChosen = (bool) (ifdef->singleBranch ||
+										  Cpp.resolveRequired);
 
-		ifdef->branchChosen = (bool) (ifdef->singleBranch ||
-										Cpp.resolveRequired);
+		if (ifdef->branchChosen != branchChosen)
+			BraceFormatDependent = true;
+		ifdef->branchChosen = branchChosen;
 	}
 }
 
@@ -936,6 +984,8 @@ static bool pushConditional (const bool firstBranchChosen)
 		ifdef->ignoring = (bool) (ignoreAllBranches || (
 				! firstBranchChosen  &&  ! BraceFormat  &&
 				(ifdef->singleBranch || !doesExaminCodeWithInIf0Branch)));
+		if (ifdef->ignoring && ! ignoreAllBranches)
+			BraceFormatDependent = true;
 		ifdef->enterExternalParserBlockNestLevel = externalParserBlockNestLevel;
 		ifdef->asmArea.line = 0;
 		ignoreBranch = ifdef->ignoring;
@@ -2027,6 +2027,10 @@ static rescanReason cxxParserMain(const unsigned int passCount)
 
 	bool bRet = cxxParserParseBlock(false);
 
+	// A rescan only changes how the preprocessor chooses conditional
+	// branches: if no choice depended on it, it would fail the same way.
+	bool bRescanUseful = cppIsBraceFormatDependent();
+
 	cppTerminate ();
 
 	// Shut up coveralls: LCOV_EXCL_START
@@ -2039,6 +2043,11 @@ static rescanReason cxxParserMain(const unsigned int passCount)
 
 	if(!bRet && (passCount == 1))
 	{
+		if(!bRescanUseful)
+		{
+			CXX_DEBUG_PRINT("Processing failed: a rescan would give the same result");
+			return RESCAN_NONE;
+		}
 		CXX_DEBUG_PRINT("Processing failed: trying to rescan");
 		return RESCAN_FAILED;
 	}
@@ -2098,6 +2107,7 @@ static void cxxParserFirstInit(void)
 	g_cxx.eCPPLangType = -1;
 	g_cxx.eCUDALangType = -1;
 
+	cxxTokenChainAPIInit();
 	cxxTokenAPIInit();
 
 	g_cxx.pTokenChain = cxxTokenChainCreate();
@@ -2162,5 +2172,7 @@ void cxxParserCleanup(langType language CTAGS_ATTR_UNUSED,bool initialized CTAGS
 
 	cxxScopeDone();
 
+	// Pooled tokens may still own side chains: release them first
 	cxxTokenAPIDone();
+	cxxTokenChainAPIDone();
 }
@@ -21,6 +21,9 @@
 #include "cxx_tag.h"
 
 #define CXX_TOKEN_POOL_MAXIMUM_SIZE 8192
+// Words longer than this (long string literals, mostly) are not kept
+// around in pooled tokens
+#define CXX_TOKEN_POOL_MAXIMUM_WORD_SIZE 1024
 
 static objPool * g_pTokenPool = NULL;
 
@@ -48,9 +51,15 @@ static void clearToken(CXXToken *t)
 {
 	CXX_DEBUG_ASSERT(t->pszWord,"The string shouldn't have been destroyed");
 
-	// this won't actually release memory (but we're taking care
-	// to do not create very large strings)
-	vStringClear(t->pszWord);
+	// this won't actually release memory: the word buffer is reused
+	// by the next token, unless it grew unusually large
+	if(vStringSize(t->pszWord) > CXX_TOKEN_POOL_MAXIMUM_WORD_SIZE)
+	{
+		vStringDelete(t->pszWord);
+		t->pszWord = vStringNew();
+	}
+	else
+		vStringClear(t->pszWord);
 
 	t->bFollowedBySpace = false;
 
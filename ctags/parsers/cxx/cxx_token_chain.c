@@ -14,9 +14,40 @@
 #include "vstring.h"
 #include "debug.h"
 #include "routines.h"
+#include "objpool.h"
 
 #include <string.h>
 
+// Every bracket pair and most statements get their own chain, so chains
+// are recycled through a pool just like the tokens they contain.
+#define CXX_TOKEN_CHAIN_POOL_MAXIMUM_SIZE 1024
+
+static objPool * g_pTokenChainPool = NULL;
+
+static CXXTokenChain * createTokenChain(void *createArg CTAGS_ATTR_UNUSED)
+{
+	return xMalloc(1, CXXTokenChain);
+}
+
+static void deleteTokenChain(CXXTokenChain * tc)
+{
+	eFree(tc);
+}
+
+void cxxTokenChainAPIInit(void)
+{
+	g_pTokenChainPool = objPoolNew(CXX_TOKEN_CHAIN_POOL_MAXIMUM_SIZE,
+		(objPoolCreateFunc)createTokenChain, (objPoolDeleteFunc)deleteTokenChain,
+		(objPoolClearFunc)cxxTokenChainInit,
+		NULL);
+}
+
+void cxxTokenChainAPIDone(void)
+{
+	objPoolDelete(g_pTokenChainPool);
+	g_pTokenChainPool = NULL;
+}
+
 void cxxTokenChainInit(CXXTokenChain * tc)
 {
 	Assert(tc);
@@ -27,9 +58,7 @@ void cxxTokenChainInit(CXXTokenChain * tc)
 
 CXXTokenChain * cxxTokenChainCreate(void)
 {
-	CXXTokenChain * tc = xMalloc(1, CXXTokenChain);
-	cxxTokenChainInit(tc);
-	return tc;
+	return objPoolGet(g_pTokenChainPool);
 }
 
 void cxxTokenChainDestroy(CXXTokenChain * tc)
@@ -48,7 +77,7 @@ void cxxTokenChainDestroy(CXXTokenChain * tc)
 		t = t2;
 	}
 
-	eFree(tc);
+	objPoolPut(g_pTokenChainPool, tc);
 }
 
 CXXToken * cxxTokenChainTakeFirst(CXXTokenChain * tc)
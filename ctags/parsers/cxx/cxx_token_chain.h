@@ -24,6 +24,9 @@ struct _CXXTokenChain
 // The struct is typedef'd in cxx_token.h
 // typedef struct _CXXTokenChain CXXTokenChain;
 
+void cxxTokenChainAPIInit(void);
+void cxxTokenChainAPIDone(void);
+
 CXXTokenChain * cxxTokenChainCreate(void);
 void cxxTokenChainDestroy(CXXTokenChain * tc);
 
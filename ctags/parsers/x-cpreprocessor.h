@@ -84,6 +84,7 @@ typedef enum {
 *   FUNCTION PROTOTYPES
 */
 extern bool cppIsBraceFormat (void);
+extern bool cppIsBraceFormatDependent (void);
 extern unsigned int cppGetDirectiveNestLevel (void);
 
 /* Don't forget to set useCort true in your parser.
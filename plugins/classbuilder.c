@@ -26,6 +26,7 @@
 
 #include "geanyplugin.h"
 
+GeanyPlugin		*geany_plugin;
 GeanyData		*geany_data;
 
 
@@ -1084,6 +1085,9 @@ void plugin_init(GeanyData *data)
 	GtkWidget *menu_create_gtk_class;
 	GtkWidget *menu_create_php_class;
 
+	/* only adds a menu item, so it can wait until the main window is shown */
+	plugin_set_deferred_activation(geany_plugin, TRUE);
+
 	menu_create_class1 = ui_image_menu_item_new (GTK_STOCK_ADD, _("Create Cla_ss"));
 	gtk_container_add (GTK_CONTAINER (geany->main_widgets->tools_menu), menu_create_class1);
 
@@ -30,6 +30,7 @@
 #include "geanyplugin.h"
 
 
+GeanyPlugin		*geany_plugin;
 GeanyData		*geany_data;
 
 PLUGIN_VERSION_CHECK(GEANY_API_VERSION)
@@ -362,11 +363,13 @@ static gint get_line_number_width(GeanyDocument *doc)
 static void write_latex_file(GeanyDocument *doc, const gchar *filename,
 	gboolean use_zoom, gboolean insert_line_numbers)
 {
-	GeanyEditor *editor = doc->editor;
 	ScintillaObject *sci = doc->editor->sci;
-	gint i, doc_len, style = -1, old_style = 0, column = 0;
+	gint i, doc_len, tab_width, style = -1, old_style = 0, column = 0;
 	gint k, line_number, line_number_width, line_number_max_width = 0, pad;
 	gchar c, c_next, *tmp, *date;
+	const gchar *text;
+	GArray *runs;
+	const SciStyleRun *run = NULL;
 	/* 0 - fore, 1 - back, 2 - bold, 3 - italic, 4 - font size, 5 - used(0/1) */
 	gint styles[STYLE_MAX + 1][MAX_TYPES];
 	gboolean block_open = FALSE;
@@ -390,11 +393,19 @@ static void write_latex_file(GeanyDocument *doc, const gchar *filename,
 	/* read the document and write the LaTeX code */
 	body = g_string_new("");
 	doc_len = sci_get_length(sci);
+	tab_width = sci_get_tab_width(sci);
+	runs = sci_get_style_runs(sci, 0, doc_len);
+	if (runs->len > 0)
+		run = &g_array_index(runs, SciStyleRun, 0);
+	text = sci_get_range_pointer(sci, 0, doc_len);
 	for (i = 0; i < doc_len; i++)
 	{
-		style = sci_get_style_at(sci, i);
-		c = sci_get_char_at(sci, i);
-		c_next = sci_get_char_at(sci, i + 1);
+		/* the runs cover the whole document */
+		while (i >= run->start + run->length)
+			run++;
+		style = run->style;
+		c = text[i];
+		c_next = (i + 1 < doc_len) ? text[i + 1] : '\0';
 
 		/* line numbers */
 		if (insert_line_numbers && column == 0)
@@ -445,7 +456,6 @@ static void write_latex_file(GeanyDocument *doc, const gchar *filename,
 			}
 			case '\t':
 			{
-				gint tab_width = sci_get_tab_width(editor->sci);
 				gint tab_stop = tab_width - (column % tab_width);
 
 				column += tab_stop - 1; /* -1 because we add 1 at the end of the loop */
@@ -509,6 +519,7 @@ static void write_latex_file(GeanyDocument *doc, const gchar *filename,
 		g_string_append(body, "}\n");
 		block_open = FALSE;
 	}
+	g_array_unref(runs);
 
 	/* force writing of style 0 (used at least for line breaks) */
 	styles[0][USED] = 1;
@@ -562,11 +573,13 @@ static void write_latex_file(GeanyDocument *doc, const gchar *filename,
 static void write_html_file(GeanyDocument *doc, const gchar *filename,
 	gboolean use_zoom, gboolean insert_line_numbers)
 {
-	GeanyEditor *editor = doc->editor;
 	ScintillaObject *sci = doc->editor->sci;
-	gint i, doc_len, style = -1, old_style = 0, column = 0;
+	gint i, doc_len, tab_width, style = -1, old_style = 0, column = 0;
 	gint k, line_number, line_number_width, line_number_max_width = 0, pad;
 	gchar c, c_next, *date, *doc_filename;
+	const gchar *text;
+	GArray *runs;
+	const SciStyleRun *run = NULL;
 	/* 0 - fore, 1 - back, 2 - bold, 3 - italic, 4 - font size, 5 - used(0/1) */
 	gint styles[STYLE_MAX + 1][MAX_TYPES];
 	gboolean span_open = FALSE;
@@ -602,12 +615,19 @@ static void write_html_file(GeanyDocument *doc, const gchar *filename,
 	/* read the document and write the HTML body */
 	body = g_string_new("");
 	doc_len = sci_get_length(sci);
+	tab_width = sci_get_tab_width(sci);
+	runs = sci_get_style_runs(sci, 0, doc_len);
+	if (runs->len > 0)
+		run = &g_array_index(runs, SciStyleRun, 0);
+	text = sci_get_range_pointer(sci, 0, doc_len);
 	for (i = 0; i < doc_len; i++)
 	{
-		style = sci_get_style_at(sci, i);
-		c = sci_get_char_at(sci, i);
-		/* sci_get_char_at() takes care of index boundaries and return 0 if i is too high */
-		c_next = sci_get_char_at(sci, i + 1);
+		/* the runs cover the whole document */
+		while (i >= run->start + run->length)
+			run++;
+		style = run->style;
+		c = text[i];
+		c_next = (i + 1 < doc_len) ? text[i + 1] : '\0';
 
 		/* line numbers */
 		if (insert_line_numbers && column == 0)
@@ -658,7 +678,6 @@ static void write_html_file(GeanyDocument *doc, const gchar *filename,
 			case '\t':
 			{
 				gint j;
-				gint tab_width = sci_get_tab_width(editor->sci);
 				gint tab_stop = tab_width - (column % tab_width);
 
 				column += tab_stop - 1; /* -1 because we add 1 at the end of the loop */
@@ -697,6 +716,7 @@ static void write_html_file(GeanyDocument *doc, const gchar *filename,
 		g_string_append(body, "</span>");
 		span_open = FALSE;
 	}
+	g_array_unref(runs);
 
 	/* write used styles in the header */
 	css = g_string_new("");
@@ -743,6 +763,9 @@ void plugin_init(GeanyData *data)
 	GtkWidget *menu_create_html;
 	GtkWidget *menu_create_latex;
 
+	/* only adds a menu item, so it can wait until the main window is shown */
+	plugin_set_deferred_activation(geany_plugin, TRUE);
+
 	menu_export = gtk_image_menu_item_new_with_mnemonic(_("_Export"));
 	gtk_container_add(GTK_CONTAINER(geany->main_widgets->tools_menu), menu_export);
 
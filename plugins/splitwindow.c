@@ -140,14 +140,8 @@ static void on_sci_notify(ScintillaObject *sci, gint param,
 
 static void sync_to_current(ScintillaObject *sci, ScintillaObject *current)
 {
-	gpointer sdoc;
 	gint pos;
 
-	/* set the new sci widget to view the existing Scintilla document */
-	sdoc = (gpointer) scintilla_send_message(current, SCI_GETDOCPOINTER, 0, 0);
-	scintilla_send_message(sci, SCI_SETDOCPOINTER, 0, (sptr_t) sdoc);
-
-	highlighting_set_styles(sci, edit_window.editor->document->file_type);
 	pos = sci_get_current_position(current);
 	sci_set_current_position(sci, pos, TRUE);
 
@@ -170,7 +164,8 @@ static void set_editor(EditWindow *editwin, GeanyEditor *editor)
 	if (editwin->sci != NULL)
 		gtk_widget_destroy(GTK_WIDGET(editwin->sci));
 
-	editwin->sci = editor_create_widget(editor);
+	/* the new sci widget views the existing Scintilla document and reuses its styling */
+	editwin->sci = editor_create_view(editor);
 	gtk_widget_show(GTK_WIDGET(editwin->sci));
 	gtk_box_pack_start(GTK_BOX(editwin->vbox), GTK_WIDGET(editwin->sci), TRUE, TRUE, 0);
 
@@ -478,7 +473,10 @@ static void on_document_filetype_set(GObject *obj, GeanyDocument *doc,
 {
 	/* update styles */
 	if (edit_window.editor == doc->editor)
+	{
+		editor_update_view(doc->editor, edit_window.sci);
 		sync_to_current(edit_window.sci, doc->editor->sci);
+	}
 }
 
 
@@ -25,6 +25,11 @@
 #include <memory>
 #include <chrono>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FIND_FOLDED_SSE2
+#include <emmintrin.h>
+#endif
+
 #ifndef NO_CXX11_REGEX
 #include <regex>
 #endif
@@ -2271,6 +2276,48 @@ ptrdiff_t SplitFindChar(const SplitView &view, size_t start, size_t length, int
 	return -1;
 }
 
+// Find the first byte that may start a case-insensitive match of a UTF-8 search
+// whose folded form starts with the byte lower: either lower itself, its upper case
+// ASCII form or any non-ASCII byte as characters like KELVIN SIGN fold to ASCII.
+const char *FindFoldedChar(const char *s, size_t length, unsigned char lower, unsigned char upper) noexcept {
+	const char *end = s + length;
+#ifdef FIND_FOLDED_SSE2
+	const __m128i vLower = _mm_set1_epi8(static_cast<char>(lower));
+	const __m128i vUpper = _mm_set1_epi8(static_cast<char>(upper));
+	for (; end - s >= 16; s += 16) {
+		const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s));
+		const __m128i cased = _mm_or_si128(_mm_cmpeq_epi8(chunk, vLower), _mm_cmpeq_epi8(chunk, vUpper));
+		// High bit of each byte is set for non-ASCII bytes
+		if (_mm_movemask_epi8(_mm_or_si128(cased, chunk)))
+			break;
+	}
+#endif
+	for (; s < end; s++) {
+		const unsigned char ch = *s;
+		if (ch == lower || ch == upper || !UTF8IsAscii(ch))
+			return s;
+	}
+	return nullptr;
+}
+
+// FindFoldedChar over the split view
+ptrdiff_t SplitFindFoldedChar(const SplitView &view, size_t start, size_t length, unsigned char lower, unsigned char upper) noexcept {
+	size_t range1Length = 0;
+	if (start < view.length1) {
+		range1Length = std::min(length, view.length1 - start);
+		const char *match = FindFoldedChar(view.segment1 + start, range1Length, lower, upper);
+		if (match) {
+			return match - view.segment1;
+		}
+		start += range1Length;
+	}
+	const char *match2 = FindFoldedChar(view.segment2 + start, length - range1Length, lower, upper);
+	if (match2) {
+		return match2 - view.segment2;
+	}
+	return -1;
+}
+
 // Equivalent of memcmp over the split view
 // This does not call memcmp as search texts are commonly too short to overcome the
 // call overhead.
@@ -2371,7 +2418,16 @@ Sci::Position Document::FindText(Sci::Position minPos, Sci::Position maxPos, con
 			std::vector<char> searchThing((lengthFind+1) * UTF8MaxBytes * maxFoldingExpansion + 1);
 			const size_t lenSearch =
 				pcf->Fold(searchThing.data(), searchThing.size(), search, lengthFind);
+			const unsigned char lowerFirst = searchThing[0];
+			const unsigned char upperFirst = IsLowerCase(lowerFirst) ? MakeUpperCase(lowerFirst) : lowerFirst;
 			while (forward ? (pos < endPos) : (pos >= endPos)) {
+				if (forward) {
+					// Skip ahead to the next byte that can start a match
+					pos = SplitFindFoldedChar(cbView, pos, endPos - pos, lowerFirst, upperFirst);
+					if (pos < 0) {
+						break;
+					}
+				}
 				int widthFirstCharacter = 1;
 				Sci::Position posIndexDocument = pos;
 				size_t indexSearch = 0;
@@ -0,0 +1,185 @@
+#!/usr/bin/env python3
+#
+# License: GPL v2 or later
+#
+# Generates large synthetic source files for tests/bench_parsers, e.g.:
+#
+#   scripts/gen-parser-bench-input.py --size 8 /tmp/bench
+#   top_srcdir=. _build/tests/bench_parsers --json /tmp/bench
+#
+# The output is deterministic for a given --seed so that numbers from
+# different commits can be compared.
+
+import argparse
+import os
+import random
+
+
+def ident(rng, prefix):
+    return '{}_{:x}'.format(prefix, rng.getrandbits(32))
+
+
+def gen_c(rng, i):
+    name = ident(rng, 'func')
+    struct = ident(rng, 'state')
+    return '''
+/* block {i} */
+#define {macro}(x) ((x) * {i})
+
+typedef struct {struct}
+{{
+	int count;
+	const char *label;
+	struct {struct} *next;
+}} {struct}_t;
+
+static int {name}(struct {struct} *s, int n)
+{{
+	int total = 0;
+
+	for (int k = 0; k < n; k++)
+	{{
+		if (s->count > k)
+			total += {macro}(k);
+#ifdef USE_LABELS
+		else if (s->label)
+			total--;
+#endif
+	}}
+	return total;
+}}
+'''.format(i=i, name=name, struct=struct, macro=ident(rng, 'MACRO').upper())
+
+
+def gen_cpp(rng, i):
+    ns = ident(rng, 'ns')
+    cls = ident(rng, 'Widget')
+    return '''
+// block {i}
+namespace {ns} {{
+
+template <typename T>
+class {cls} : public Base<T>
+{{
+public:
+	explicit {cls}(const std::vector<T> &items) : m_items(items) {{}}
+	virtual ~{cls}() override = default;
+
+	template <typename F>
+	auto map(F &&f) const -> std::vector<decltype(f(std::declval<T>()))>
+	{{
+		std::vector<decltype(f(std::declval<T>()))> out;
+		for (const auto &item : m_items)
+			out.push_back(f(item));
+		return out;
+	}}
+
+	enum class Mode {{ First, Second = {i}, Third }};
+
+private:
+	std::vector<T> m_items;
+	Mode m_mode = Mode::First;
+}};
+
+int {fn}(int a, int b) {{ return [a](int c) {{ return a + c; }}(b); }}
+
+}} // namespace {ns}
+'''.format(i=i, ns=ns, cls=cls, fn=ident(rng, 'helper'))
+
+
+def gen_python(rng, i):
+    cls = ident(rng, 'Model')
+    return '''
+# block {i}
+class {cls}(object):
+    """Synthetic class {i}."""
+
+    LIMIT = {i}
+
+    def __init__(self, items=None):
+        self.items = list(items or [])
+
+    @property
+    def size(self):
+        return len(self.items)
+
+    def {meth}(self, value, *args, **kwargs):
+        def inner(x):
+            return x * self.LIMIT
+        return [inner(v) for v in self.items if v > value]
+
+
+async def {fn}(session, url="http://example.org/{i}"):
+    async with session.get(url) as response:
+        return await response.text()
+'''.format(i=i, cls=cls, meth=ident(rng, 'method'), fn=ident(rng, 'fetch'))
+
+
+def gen_js(rng, i):
+    cls = ident(rng, 'Component')
+    return '''
+// block {i}
+class {cls} extends Base {{
+	constructor(props) {{
+		super(props);
+		this.state = {{ count: {i}, label: 'item-{i}' }};
+	}}
+
+	{meth}(value) {{
+		const items = this.props.items.filter((x) => x > value);
+		return items.map(function (x) {{ return x * 2; }});
+	}}
+}}
+
+const {obj} = {{
+	name: "{cls}",
+	create: function (props) {{ return new {cls}(props); }},
+	nested: {{ depth: {i}, run() {{ return this.depth; }} }},
+}};
+
+export function {fn}(a, b = {i}) {{
+	return `${{a}}-${{b}}`;
+}}
+'''.format(i=i, cls=cls, meth=ident(rng, 'method'), obj=ident(rng, 'registry'),
+           fn=ident(rng, 'format'))
+
+
+GENERATORS = {
+    'c': ('#include <stdio.h>\n', gen_c),
+    'cpp': ('#include <vector>\n#include <utility>\n', gen_cpp),
+    'py': ('import asyncio\n', gen_python),
+    'js': ('"use strict";\n', gen_js),
+}
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate synthetic inputs for bench_parsers')
+    parser.add_argument('--size', type=float, default=4,
+                        help='approximate size of each file in MiB (default: 4)')
+    parser.add_argument('--seed', type=int, default=1, help='random seed (default: 1)')
+    parser.add_argument('--lang', action='append', choices=sorted(GENERATORS),
+                        help='language to generate, may be repeated (default: all)')
+    parser.add_argument('directory', help='output directory')
+    args = parser.parse_args()
+
+    os.makedirs(args.directory, exist_ok=True)
+    limit = int(args.size * 1024 * 1024)
+
+    for lang in args.lang or sorted(GENERATORS):
+        header, gen = GENERATORS[lang]
+        rng = random.Random(args.seed)
+        path = os.path.join(args.directory, 'synthetic.' + lang)
+        written = 0
+        with open(path, 'w') as f:
+            f.write(header)
+            i = 0
+            while written < limit:
+                block = gen(rng, i)
+                f.write(block)
+                written += len(block)
+                i += 1
+        print('{}: {} bytes'.format(path, written))
+
+
+if __name__ == '__main__':
+    main()
@@ -451,8 +451,7 @@ void on_entry_tagfilter_changed(GtkAction *action, gpointer user_data)
 
 	/* make sure the tree is fully re-created so it appears correctly
 	 * after applying filter */
-	if (doc->priv->tag_store)
-		gtk_tree_store_clear(doc->priv->tag_store);
+	symbols_clear_tag_list(doc);
 	sidebar_update_tag_list(doc, TRUE);
 }
 
@@ -44,6 +44,7 @@
 #include "msgwindow.h"
 #include "navqueue.h"
 #include "notebook.h"
+#include "perflog.h"
 #include "pluginextension.h"
 #include "project.h"
 #include "sciwrappers.h"
@@ -109,6 +110,7 @@ static guint doc_id_counter = 0;
 
 static void document_undo_clear_stack(GSList **stack);
 static void document_undo_clear(GeanyDocument *doc);
+static void undo_spill_free(GeanyDocument *doc);
 static void document_undo_add_internal(GeanyDocument *doc, guint type, gpointer data);
 static void document_redo_add(GeanyDocument *doc, guint type, gpointer data);
 static gboolean remove_page(guint page_num);
@@ -688,6 +690,10 @@ static gboolean remove_page(guint page_num)
 		tm_source_file_free(doc->tm_file);
 	}
 
+	if (doc->priv->tag_rows)
+		g_hash_table_destroy(doc->priv->tag_rows);
+	if (doc->priv->tag_group_rows)
+		g_ptr_array_free(doc->priv->tag_group_rows, TRUE);
 	if (doc->priv->tag_tree)
 		gtk_widget_destroy(doc->priv->tag_tree);
 
@@ -2586,13 +2592,7 @@ gint document_replace_all(GeanyDocument *doc, const gchar *find_text, const gcha
 }
 
 
-/*
- * Parses or re-parses the document's buffer and updates the type
- * keywords and symbol list.
- *
- * @param doc The document.
- */
-void document_update_tags(GeanyDocument *doc)
+static void update_tags(GeanyDocument *doc)
 {
 	guchar *buffer_ptr;
 	gsize len;
@@ -2646,8 +2646,22 @@ void document_update_tags(GeanyDocument *doc)
 }
 
 
-/* Re-highlights type keywords without re-parsing the whole document. */
-void document_highlight_tags(GeanyDocument *doc)
+/*
+ * Parses or re-parses the document's buffer and updates the type
+ * keywords and symbol list.
+ *
+ * @param doc The document.
+ */
+void document_update_tags(GeanyDocument *doc)
+{
+	gint64 start = perf_log_begin();
+
+	update_tags(doc);
+	perf_log_end(PERF_STAGE_UPDATE_TAGS, start, DOC_VALID(doc) ? doc->id : 0, -1);
+}
+
+
+static void highlight_tags(GeanyDocument *doc)
 {
 	GString *keywords_str;
 	gint keyword_idx;
@@ -2685,6 +2699,11 @@ void document_highlight_tags(GeanyDocument *doc)
 	if (!app->tm_workspace->tags_array)
 		return;
 
+	/* most tag updates don't add or remove any typename, so avoid rebuilding the list */
+	if (doc->priv->keyword_serial == app->tm_workspace->typename_serial)
+		return;
+	doc->priv->keyword_serial = app->tm_workspace->typename_serial;
+
 	/* get any type keywords and tell scintilla about them
 	 * this will cause the type keywords to be colourized in scintilla */
 	keywords_str = symbols_find_typenames_as_string(doc->file_type->lang, FALSE);
@@ -2695,8 +2714,11 @@ void document_highlight_tags(GeanyDocument *doc)
 
 		if (hash != doc->priv->keyword_hash)
 		{
+			/* Scintilla invalidates the styling itself when the keywords change, so
+			 * just redraw to restyle the visible part instead of colourising the whole
+			 * document; the rest is styled lazily when it is shown */
 			sci_set_keywords(doc->editor->sci, keyword_idx, keywords);
-			queue_colourise(doc); /* force re-highlighting the entire document */
+			gtk_widget_queue_draw(GTK_WIDGET(doc->editor->sci));
 			doc->priv->keyword_hash = hash;
 		}
 		g_free(keywords);
@@ -2704,6 +2726,16 @@ void document_highlight_tags(GeanyDocument *doc)
 }
 
 
+/* Re-highlights type keywords without re-parsing the whole document. */
+void document_highlight_tags(GeanyDocument *doc)
+{
+	gint64 start = perf_log_begin();
+
+	highlight_tags(doc);
+	perf_log_end(PERF_STAGE_HIGHLIGHT_TAGS, start, doc->id, -1);
+}
+
+
 static gboolean on_document_update_tag_list_idle(gpointer data)
 {
 	GeanyDocument *doc = data;
@@ -2764,6 +2796,7 @@ static void document_load_config(GeanyDocument *doc, GeanyFiletype *type,
 		/* forces re-setting SCI_SETKEYWORDS which seems to be needed with
 		 * Scintilla 5 to colorize them properly */
 		doc->priv->keyword_hash = 0;
+		doc->priv->keyword_serial = 0;
 		if (type->priv->symbol_list_sort_mode == SYMBOLS_SORT_USE_PREVIOUS)
 			doc->priv->symbol_list_sort_mode = interface_prefs.symbols_sort_mode;
 		else
@@ -2850,25 +2883,30 @@ void document_set_encoding(GeanyDocument *doc, const gchar *new_encoding)
  * to the encoding or the Unicode BOM (which are Scintilla independent).
  * All Scintilla events are stored in the undo / redo buffer and are passed through. */
 
+static void undo_action_free(undo_action *a)
+{
+	if (G_LIKELY(a != NULL))
+	{
+		switch (a->type)
+		{
+			case UNDO_ENCODING:
+			case UNDO_RELOAD:
+				g_free(a->data); break;
+			default: break;
+		}
+		g_free(a);
+	}
+}
+
+
 /* Clears an Undo or Redo buffer. */
 void document_undo_clear_stack(GSList **stack)
 {
 	while (*stack)
 	{
 		GSList *top = *stack;
-		undo_action *a = top->data;
 
-		if (G_LIKELY(a != NULL))
-		{
-			switch (a->type)
-			{
-				case UNDO_ENCODING:
-				case UNDO_RELOAD:
-					g_free(a->data); break;
-				default: break;
-			}
-			g_free(a);
-		}
+		undo_action_free(top->data);
 
 		*stack = top->next;
 		g_slist_free1(top);
@@ -2880,6 +2918,8 @@ void document_undo_clear(GeanyDocument *doc)
 {
 	document_undo_clear_stack(&doc->priv->undo_actions);
 	document_undo_clear_stack(&doc->priv->redo_actions);
+	undo_spill_free(doc);
+	doc->priv->undo_bytes = 0;
 
 	if (! main_status.quitting && doc->editor != NULL)
 		document_set_text_changed(doc, FALSE);
@@ -2919,11 +2959,530 @@ void document_undo_add(GeanyDocument *doc, guint type, gpointer data)
 }
 
 
+/* Bounded undo history.
+ *
+ * Scintilla keeps the text of every undoable change in memory for the lifetime of the
+ * document. Once a history grows beyond file_prefs.undo_memory_limit, or all of them
+ * together beyond file_prefs.undo_memory_limit_total, its oldest user operations are
+ * written to a temporary file and Scintilla's history is rebuilt without them. They are
+ * read back when undo reaches the oldest operation still in memory. */
+
+/* rough size of Scintilla's bookkeeping for an action, on top of its text */
+#define UNDO_ACTION_OVERHEAD 8
+/* flag of actions that continue into the next one, see SCI_GETUNDOACTIONTYPE */
+#define UNDO_ACTION_MAY_COALESCE 0x100
+
+/* trim below the limit so that it is not hit again on the next keystroke */
+#define UNDO_TRIM_TARGET(limit) ((limit) / 4 * 3)
+#define MIB_TO_BYTES(mib) ((gsize) MAX((mib), 0) * 1024 * 1024)
+
+typedef struct
+{
+	gint type;
+	gint position;
+	gsize length;
+	gchar *text;
+}
+UndoRecord;
+
+/* an action as stored in the spill file, followed by its text */
+typedef struct
+{
+	gint32 type;
+	gint32 position;
+	guint64 length;
+}
+UndoSpillHeader;
+
+typedef struct
+{
+	goffset offset;		/* start of the chunk in the spill file */
+	gint actions;
+	guint operations;	/* number of UNDO_SCINTILLA entries that went with it */
+	gsize bytes;
+	/* save and detach points that were inside the chunk, or -1 */
+	gint save_point;
+	gint detach;
+}
+UndoSpillChunk;
+
+struct UndoSpill
+{
+	GFile *file;
+	GFileIOStream *stream;
+	GArray *chunks;
+};
+
+static guint undo_limit_source = 0;
+
+
+static void undo_record_clear(gpointer data)
+{
+	UndoRecord *record = data;
+
+	g_free(record->text);
+}
+
+
+static gsize undo_action_size(gsize length)
+{
+	return length + UNDO_ACTION_OVERHEAD;
+}
+
+
+/* Copies actions from..end of Scintilla's undo history */
+static GArray *read_undo_records(ScintillaObject *sci, gint from)
+{
+	gint n_actions = sci_get_undo_actions(sci);
+	GArray *records = g_array_sized_new(FALSE, FALSE, sizeof(UndoRecord), MAX(n_actions - from, 0));
+	gint i;
+
+	g_array_set_clear_func(records, undo_record_clear);
+	/* texts are looked up incrementally from the last one read, which must be reset first */
+	if (n_actions > 0)
+		sci_get_undo_action_text(sci, 0, NULL);
+	for (i = from; i < n_actions; i++)
+	{
+		UndoRecord record;
+
+		record.type = sci_get_undo_action_type(sci, i);
+		record.position = sci_get_undo_action_position(sci, i);
+		record.length = sci_get_undo_action_text(sci, i, NULL);
+		record.text = NULL;
+		if (record.length > 0)
+		{
+			record.text = g_malloc(record.length);
+			sci_get_undo_action_text(sci, i, record.text);
+		}
+		g_array_append_val(records, record);
+	}
+	return records;
+}
+
+
+static void push_undo_records(ScintillaObject *sci, GArray *records)
+{
+	guint i;
+
+	for (i = 0; i < records->len; i++)
+	{
+		UndoRecord *record = &g_array_index(records, UndoRecord, i);
+
+		sci_push_undo_action(sci, record->type, record->position, record->text, record->length);
+	}
+}
+
+
+static void undo_spill_free(GeanyDocument *doc)
+{
+	struct UndoSpill *spill = doc->priv->undo_spill;
+
+	if (spill == NULL)
+		return;
+
+	g_io_stream_close(G_IO_STREAM(spill->stream), NULL, NULL);
+	g_object_unref(spill->stream);
+	g_file_delete(spill->file, NULL, NULL);
+	g_object_unref(spill->file);
+	g_array_free(spill->chunks, TRUE);
+	g_free(spill);
+	doc->priv->undo_spill = NULL;
+}
+
+
+/* Appends the first chunk->actions records to the spill file and records the chunk */
+static gboolean undo_spill_write(GeanyDocument *doc, GArray *records, UndoSpillChunk *chunk,
+		GError **error)
+{
+	struct UndoSpill *spill = doc->priv->undo_spill;
+	GOutputStream *output;
+	gboolean success = TRUE;
+	gint i;
+
+	if (spill == NULL)
+	{
+		GFileIOStream *stream;
+		GFile *file = g_file_new_tmp("geany_undo_XXXXXX", &stream, error);
+
+		if (file == NULL)
+			return FALSE;
+
+		spill = g_new0(struct UndoSpill, 1);
+		spill->file = file;
+		spill->stream = stream;
+		spill->chunks = g_array_new(FALSE, FALSE, sizeof(UndoSpillChunk));
+		doc->priv->undo_spill = spill;
+	}
+
+	output = g_io_stream_get_output_stream(G_IO_STREAM(spill->stream));
+	success = g_seekable_seek(G_SEEKABLE(spill->stream), 0, G_SEEK_END, NULL, error);
+	chunk->offset = g_seekable_tell(G_SEEKABLE(spill->stream));
+	for (i = 0; success && i < chunk->actions; i++)
+	{
+		UndoRecord *record = &g_array_index(records, UndoRecord, i);
+		UndoSpillHeader header = { record->type, record->position, record->length };
+
+		success = g_output_stream_write_all(output, &header, sizeof(header), NULL, NULL, error) &&
+			(record->length == 0 ||
+			 g_output_stream_write_all(output, record->text, record->length, NULL, NULL, error));
+	}
+
+	if (success)
+		g_array_append_val(spill->chunks, *chunk);
+	else if (spill->chunks->len == 0)
+		undo_spill_free(doc);
+	else
+		g_seekable_truncate(G_SEEKABLE(spill->stream), chunk->offset, NULL, NULL);
+	return success;
+}
+
+
+static GArray *undo_spill_read(struct UndoSpill *spill, const UndoSpillChunk *chunk, GError **error)
+{
+	GInputStream *input = g_io_stream_get_input_stream(G_IO_STREAM(spill->stream));
+	GArray *records = g_array_sized_new(FALSE, FALSE, sizeof(UndoRecord), chunk->actions);
+	gint i;
+
+	g_array_set_clear_func(records, undo_record_clear);
+	if (! g_seekable_seek(G_SEEKABLE(spill->stream), chunk->offset, G_SEEK_SET, NULL, error))
+	{
+		g_array_free(records, TRUE);
+		return NULL;
+	}
+	for (i = 0; i < chunk->actions; i++)
+	{
+		UndoSpillHeader header;
+		UndoRecord record = { 0, 0, 0, NULL };
+		gsize n_read;
+
+		if (! g_input_stream_read_all(input, &header, sizeof(header), &n_read, NULL, error) ||
+			n_read != sizeof(header))
+			break;
+		record.type = header.type;
+		record.position = header.position;
+		record.length = header.length;
+		if (record.length > 0)
+		{
+			record.text = g_malloc(record.length);
+			if (! g_input_stream_read_all(input, record.text, record.length, &n_read, NULL, error) ||
+				n_read != record.length)
+			{
+				g_free(record.text);
+				break;
+			}
+		}
+		g_array_append_val(records, record);
+	}
+	if (i < chunk->actions)
+	{
+		if (error && *error == NULL)
+			g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_PARTIAL_INPUT, g_strerror(EIO));
+		g_array_free(records, TRUE);
+		return NULL;
+	}
+	return records;
+}
+
+
+/* Drops the oldest entries of the undo stack up to the operations-th UNDO_SCINTILLA,
+ * after as many operations were removed from Scintilla's history */
+static void drop_oldest_undo_actions(GeanyDocument *doc, guint operations)
+{
+	GSList *stack = g_slist_reverse(doc->priv->undo_actions);
+	GSList *node;
+	guint below;
+
+	while (stack && operations > 0)
+	{
+		undo_action *action = stack->data;
+
+		if (action->type == UNDO_SCINTILLA)
+			operations--;
+		undo_action_free(action);
+		stack = g_slist_delete_link(stack, stack);
+	}
+	/* an UNDO_EOL belongs to the UNDO_SCINTILLA below it */
+	while (stack && ((undo_action *) stack->data)->type == UNDO_EOL)
+	{
+		undo_action_free(stack->data);
+		stack = g_slist_delete_link(stack, stack);
+	}
+
+	/* reloads must not undo more entries than are left below them */
+	for (node = stack, below = 0; node != NULL; node = node->next, below++)
+	{
+		undo_action *action = node->data;
+
+		if (action->type == UNDO_RELOAD)
+		{
+			UndoReloadData *data = (UndoReloadData *) action->data;
+
+			data->actions_count = MIN(data->actions_count, below);
+		}
+	}
+	doc->priv->undo_actions = g_slist_reverse(stack);
+}
+
+
+/* Drops what is left of doc's undo history after Scintilla rejected and discarded
+ * the history rebuilt from it */
+static void undo_history_lost(GeanyDocument *doc)
+{
+	ScintillaObject *sci = doc->editor->sci;
+	gboolean changed = doc->changed;
+
+	ui_set_statusbar(TRUE, _("Could not rebuild the undo history of %s, it has been cleared."),
+		DOC_FILENAME(doc));
+	sci_empty_undo_buffer(sci);
+	document_undo_clear(doc);
+	/* without history Scintilla takes the text as saved */
+	if (changed)
+	{
+		sci_set_undo_save_point(sci, -1);
+		document_set_text_changed(doc, TRUE);
+	}
+}
+
+
+/* Moves the oldest user operations of doc's undo history out of memory until at most
+ * target bytes remain. Operations after the current one, i.e. redo, are never moved. */
+static void undo_limit_trim(GeanyDocument *doc, gsize target)
+{
+	ScintillaObject *sci = doc->editor->sci;
+	GError *error = NULL;
+	GArray *records;
+	UndoSpillChunk chunk = { 0, 0, 0, 0, -1, -1 };
+	gint n_actions, current, save_point, detach, i;
+	gsize size = 0, dropped = 0;
+	guint operations = 0;
+
+	if (sci_is_undo_sequence_open(sci))
+		return;
+
+	n_actions = sci_get_undo_actions(sci);
+	if (n_actions > 0)
+		sci_get_undo_action_text(sci, 0, NULL);
+	for (i = 0; i < n_actions; i++)
+		size += undo_action_size(sci_get_undo_action_text(sci, i, NULL));
+	doc->priv->undo_bytes = size;
+
+	/* cut after the last action of a user operation */
+	current = sci_get_undo_current(sci);
+	for (i = 0; i < current && size - dropped > target; i++)
+	{
+		dropped += undo_action_size(sci_get_undo_action_text(sci, i, NULL));
+		if (! (sci_get_undo_action_type(sci, i) & UNDO_ACTION_MAY_COALESCE))
+		{
+			chunk.actions = i + 1;
+			chunk.bytes = dropped;
+			operations++;
+		}
+	}
+	if (chunk.actions == 0)
+		return;
+
+	save_point = sci_get_undo_save_point(sci);
+	detach = sci_get_undo_detach(sci);
+	chunk.operations = operations;
+	if (save_point >= 0 && save_point < chunk.actions)
+		chunk.save_point = save_point;
+	else if (save_point < 0 && detach >= 0 && detach < chunk.actions)
+		chunk.detach = detach;
+
+	records = read_undo_records(sci, 0);
+	if (! undo_spill_write(doc, records, &chunk, &error))
+	{
+		/* still honour the limit, the user asked for it */
+		ui_set_statusbar(TRUE, _("Could not move the undo history of %s out of memory, "
+			"discarding its oldest part (%s)."), DOC_FILENAME(doc), error->message);
+		g_error_free(error);
+	}
+
+	sci_empty_undo_buffer(sci);
+	g_array_remove_range(records, 0, chunk.actions);
+	push_undo_records(sci, records);
+	g_array_free(records, TRUE);
+	/* a save point and a detach point are mutually exclusive */
+	if (save_point >= chunk.actions)
+	{
+		sci_set_undo_save_point(sci, save_point - chunk.actions);
+		sci_set_undo_detach(sci, -1);
+	}
+	else
+	{
+		sci_set_undo_save_point(sci, -1);
+		sci_set_undo_detach(sci, MAX(detach - chunk.actions, 0));
+	}
+	if (! sci_set_undo_current(sci, current - chunk.actions))
+	{
+		undo_history_lost(doc);
+		return;
+	}
+
+	drop_oldest_undo_actions(doc, operations);
+	doc->priv->undo_bytes = size - chunk.bytes;
+}
+
+
+/* Brings back the operations moved out of memory last by undo_limit_trim() */
+static void undo_spill_restore(GeanyDocument *doc)
+{
+	struct UndoSpill *spill = doc->priv->undo_spill;
+	ScintillaObject *sci = doc->editor->sci;
+	UndoSpillChunk chunk;
+	GError *error = NULL;
+	GArray *spilled, *records;
+	GSList *restored = NULL;
+	gint current, save_point, detach;
+	guint i;
+
+	if (sci_is_undo_sequence_open(sci))
+		return;
+
+	chunk = g_array_index(spill->chunks, UndoSpillChunk, spill->chunks->len - 1);
+	spilled = undo_spill_read(spill, &chunk, &error);
+	if (spilled == NULL)
+	{
+		ui_set_statusbar(TRUE, _("Could not restore the undo history of %s (%s)."),
+			DOC_FILENAME(doc), error->message);
+		g_error_free(error);
+		undo_spill_free(doc);
+		return;
+	}
+
+	current = sci_get_undo_current(sci);
+	save_point = sci_get_undo_save_point(sci);
+	detach = sci_get_undo_detach(sci);
+	records = read_undo_records(sci, 0);
+
+	sci_empty_undo_buffer(sci);
+	push_undo_records(sci, spilled);
+	push_undo_records(sci, records);
+	g_array_free(spilled, TRUE);
+	g_array_free(records, TRUE);
+	if (save_point >= 0)
+	{
+		sci_set_undo_save_point(sci, save_point + chunk.actions);
+		sci_set_undo_detach(sci, -1);
+	}
+	else if (detach > 0 || chunk.save_point < 0)
+	{
+		sci_set_undo_save_point(sci, -1);
+		sci_set_undo_detach(sci, detach > 0 ? detach + chunk.actions : MAX(chunk.detach, 0));
+	}
+	else
+	{
+		sci_set_undo_save_point(sci, chunk.save_point);
+		sci_set_undo_detach(sci, -1);
+	}
+	if (! sci_set_undo_current(sci, current + chunk.actions))
+	{
+		undo_history_lost(doc);
+		return;
+	}
+
+	for (i = 0; i < chunk.operations; i++)
+	{
+		undo_action *action = g_new0(undo_action, 1);
+
+		action->type = UNDO_SCINTILLA;
+		restored = g_slist_prepend(restored, action);
+	}
+	doc->priv->undo_actions = g_slist_concat(doc->priv->undo_actions, restored);
+	doc->priv->undo_bytes += chunk.bytes;
+
+	g_array_set_size(spill->chunks, spill->chunks->len - 1);
+	if (spill->chunks->len == 0)
+		undo_spill_free(doc);
+	else
+		g_seekable_truncate(G_SEEKABLE(spill->stream), chunk.offset, NULL, NULL);
+}
+
+
+static gint compare_undo_bytes(gconstpointer a, gconstpointer b)
+{
+	const GeanyDocument *doc_a = *((const GeanyDocument **) a);
+	const GeanyDocument *doc_b = *((const GeanyDocument **) b);
+
+	if (doc_a->priv->undo_bytes == doc_b->priv->undo_bytes)
+		return 0;
+	return doc_a->priv->undo_bytes < doc_b->priv->undo_bytes ? 1 : -1;
+}
+
+
+static gboolean undo_limit_idle(gpointer data)
+{
+	const gsize limit = MIB_TO_BYTES(file_prefs.undo_memory_limit);
+	const gsize total_limit = MIB_TO_BYTES(file_prefs.undo_memory_limit_total);
+	gsize total = 0;
+	guint i;
+
+	undo_limit_source = 0;
+
+	foreach_document(i)
+	{
+		GeanyDocument *doc = documents[i];
+
+		/* the size is only estimated while editing, undo_limit_trim() measures it */
+		if (limit > 0 && doc->priv->undo_bytes > limit)
+			undo_limit_trim(doc, UNDO_TRIM_TARGET(limit));
+		total += doc->priv->undo_bytes;
+	}
+
+	if (total_limit > 0 && total > total_limit)
+	{
+		const gsize target = UNDO_TRIM_TARGET(total_limit);
+		GPtrArray *docs = g_ptr_array_new();
+
+		foreach_document(i)
+			g_ptr_array_add(docs, documents[i]);
+		/* trim the largest histories first */
+		g_ptr_array_sort(docs, compare_undo_bytes);
+		for (i = 0; i < docs->len && total > target; i++)
+		{
+			GeanyDocument *doc = g_ptr_array_index(docs, i);
+			gsize before = doc->priv->undo_bytes;
+
+			undo_limit_trim(doc, before > total - target ? before - (total - target) : 0);
+			total = total - before + doc->priv->undo_bytes;
+		}
+		g_ptr_array_free(docs, TRUE);
+	}
+	return G_SOURCE_REMOVE;
+}
+
+
+/* Accounts for a change of length bytes to doc that Scintilla added to its undo
+ * history, and schedules trimming it when over the limits */
+void document_undo_account(GeanyDocument *doc, gsize length)
+{
+	gboolean exceeded = FALSE;
+
+	doc->priv->undo_bytes += undo_action_size(length);
+	if (undo_limit_source != 0)
+		return;
+
+	if (file_prefs.undo_memory_limit > 0)
+		exceeded = doc->priv->undo_bytes > MIB_TO_BYTES(file_prefs.undo_memory_limit);
+	if (! exceeded && file_prefs.undo_memory_limit_total > 0)
+	{
+		gsize total = 0;
+		guint i;
+
+		foreach_document(i)
+			total += documents[i]->priv->undo_bytes;
+		exceeded = total > MIB_TO_BYTES(file_prefs.undo_memory_limit_total);
+	}
+	if (exceeded)
+		undo_limit_source = g_idle_add(undo_limit_idle, NULL);
+}
+
+
 gboolean document_can_undo(GeanyDocument *doc)
 {
 	g_return_val_if_fail(doc != NULL, FALSE);
 
-	if (doc->priv->undo_actions || sci_can_undo(doc->editor->sci))
+	if (doc->priv->undo_actions || sci_can_undo(doc->editor->sci) || doc->priv->undo_spill)
 		return TRUE;
 	else
 		return FALSE;
@@ -2947,6 +3506,14 @@ void document_undo(GeanyDocument *doc)
 
 	g_return_if_fail(doc != NULL);
 
+	/* Scintilla ran out of history, bring back what was moved out of memory */
+	if (doc->priv->undo_spill && ! sci_can_undo(doc->editor->sci) &&
+		(doc->priv->undo_actions == NULL ||
+		 ((undo_action *) doc->priv->undo_actions->data)->type == UNDO_SCINTILLA))
+	{
+		undo_spill_restore(doc);
+	}
+
 	top = doc->priv->undo_actions;
 	if (top)
 	{
@@ -67,6 +67,8 @@ typedef struct GeanyFilePrefs
 	gboolean		show_keep_edit_history_on_reload_msg; /* whether to show the message introducing the above feature */
  	gboolean		reload_clean_doc_on_file_change;
  	gboolean		save_config_on_file_change;
+	gint			undo_memory_limit;			/* MiB of undo history per document kept in memory, 0 for no limit */
+	gint			undo_memory_limit_total;	/* MiB of undo history of all documents kept in memory, 0 for no limit */
 }
 GeanyFilePrefs;
 
@@ -292,6 +294,8 @@ void document_redo(GeanyDocument *doc);
 
 void document_undo_add(GeanyDocument *doc, guint type, gpointer data);
 
+void document_undo_account(GeanyDocument *doc, gsize length);
+
 void document_update_tab_label(GeanyDocument *doc);
 
 const gchar *document_get_status_widget_class(GeanyDocument *doc);
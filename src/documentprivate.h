@@ -79,6 +79,12 @@ typedef struct GeanyDocumentPrivate
 	GtkWidget		*tag_tree;
 	/* GtkTreeStore object for this document within the Symbols treeview of the sidebar. */
 	GtkTreeStore	*tag_store;
+	/* Rows of tag_store by tag, see symbols.c:update_tree_tags(). */
+	GHashTable		*tag_rows;
+	/* Lazy group rows of tag_store, see symbols.c:add_tree_tags(). */
+	GPtrArray		*tag_group_rows;
+	/* Sort mode currently applied to tag_store. */
+	gint			tag_store_sort_mode;
 	/* Indicates whether tag tree has to be updated */
 	gboolean		tag_tree_dirty;
 	/* Iter for this document within the Open Files treeview of the sidebar. */
@@ -87,10 +93,15 @@ typedef struct GeanyDocumentPrivate
 	GSList			*undo_actions;
 	/* Used by the Undo/Redo management code. */
 	GSList			*redo_actions;
+	/* Estimated memory used by Scintilla's undo history, see document_undo_account(). */
+	gsize			 undo_bytes;
+	/* Oldest part of the undo history moved out of memory, NULL if none. */
+	struct UndoSpill *undo_spill;
 	/* Used so Undo/Redo works for encoding changes. */
 	FileEncoding	 saved_encoding;
 	gboolean		 colourise_needed;	/* use document.c:queue_colourise() instead */
 	guint			 keyword_hash;	/* hash of keyword string used for typename colourisation */
+	guint			 keyword_serial;	/* TMWorkspace::typename_serial the keywords were last checked at */
 	gint			 line_count;		/* Number of lines in the document. */
 	gint			 symbol_list_sort_mode;
 	/* indicates whether a file is on a remote filesystem, works only with GIO/GVfs */
@@ -47,10 +47,12 @@
 #include "keybindings.h"
 #include "main.h"
 #include "navqueue.h"
+#include "perflog.h"
 #include "pluginextension.h"
 #include "prefs.h"
 #include "projectprivate.h"
 #include "sciwrappers.h"
+#include "search.h"
 #include "support.h"
 #include "symbols.h"
 #include "templates.h"
@@ -1069,10 +1071,18 @@ void editor_sci_notify_cb(G_GNUC_UNUSED GtkWidget *widget, G_GNUC_UNUSED gint sc
 {
 	GeanyEditor *editor = data;
 	gboolean retval;
+	gint64 start;
+	guint doc_id;
+	gint code;
 
 	g_return_if_fail(editor != NULL);
 
+	/* a handler might close the document, freeing the editor */
+	doc_id = editor->document->id;
+	code = ((SCNotification *) scnt)->nmhdr.code;
+	start = perf_log_begin();
 	g_signal_emit_by_name(geany_object, "editor-notify", editor, scnt, &retval);
+	perf_log_end(PERF_STAGE_NOTIFY, start, doc_id, code);
 }
 
 
@@ -1090,6 +1100,7 @@ static gboolean on_editor_notify(G_GNUC_UNUSED GObject *object, GeanyEditor *edi
 {
 	ScintillaObject *sci = editor->sci;
 	GeanyDocument *doc = editor->document;
+	gint64 start = perf_log_begin();
 
 	switch (nt->nmhdr.code)
 	{
@@ -1149,6 +1160,10 @@ static gboolean on_editor_notify(G_GNUC_UNUSED GObject *object, GeanyEditor *edi
 			if (nt->modificationType & (SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT))
 			{
 				document_update_tag_list_in_idle(doc);
+				search_mark_all_cancel(doc);
+				/* undo and redo only move through the history */
+				if (nt->modificationType & SC_PERFORMED_USER)
+					document_undo_account(doc, (gsize) nt->length);
 			}
 			break;
 
@@ -1209,6 +1224,7 @@ static gboolean on_editor_notify(G_GNUC_UNUSED GObject *object, GeanyEditor *edi
 			update_margins(sci);
 			break;
 	}
+	perf_log_end(PERF_STAGE_EDITOR_NOTIFY, start, doc->id, nt->nmhdr.code);
 	/* we always return FALSE here to let plugins handle the event too */
 	return FALSE;
 }
@@ -3422,18 +3438,10 @@ gint editor_do_comment(GeanyEditor *editor, gint line, gboolean allow_empty_line
 
 static gboolean brace_timeout_active = FALSE;
 
-static gboolean delay_match_brace(G_GNUC_UNUSED gpointer user_data)
+static void match_brace(GeanyEditor *editor, gint brace_pos)
 {
-	GeanyDocument *doc = document_get_current();
-	GeanyEditor *editor;
-	gint brace_pos = GPOINTER_TO_INT(user_data);
 	gint end_pos, cur_pos;
 
-	brace_timeout_active = FALSE;
-	if (!doc)
-		return FALSE;
-
-	editor = doc->editor;
 	cur_pos = sci_get_current_position(editor->sci) - 1;
 
 	if (cur_pos != brace_pos)
@@ -3444,13 +3452,13 @@ static gboolean delay_match_brace(G_GNUC_UNUSED gpointer user_data)
 			/* we have moved past the original brace_pos, but after the timeout
 			 * we may now be on a new brace, so check again */
 			editor_highlight_braces(editor, cur_pos);
-			return FALSE;
+			return;
 		}
 	}
 	if (!utils_isbrace(sci_get_char_at(editor->sci, brace_pos), editor_prefs.brace_match_ltgt))
 	{
 		editor_highlight_braces(editor, cur_pos);
-		return FALSE;
+		return;
 	}
 	end_pos = sci_find_matching_brace(editor->sci, brace_pos);
 
@@ -3466,6 +3474,21 @@ static gboolean delay_match_brace(G_GNUC_UNUSED gpointer user_data)
 		SSM(editor->sci, SCI_SETHIGHLIGHTGUIDE, 0, 0);
 		SSM(editor->sci, SCI_BRACEBADLIGHT, brace_pos, 0);
 	}
+}
+
+
+static gboolean delay_match_brace(gpointer user_data)
+{
+	GeanyDocument *doc = document_get_current();
+	gint64 start;
+
+	brace_timeout_active = FALSE;
+	if (!doc)
+		return FALSE;
+
+	start = perf_log_begin();
+	match_brace(doc->editor, GPOINTER_TO_INT(user_data));
+	perf_log_end(PERF_STAGE_BRACE_MATCH, start, doc->id, -1);
 	return FALSE;
 }
 
@@ -4806,12 +4829,15 @@ on_editor_scroll_event(GtkWidget *widget, GdkEventScroll *event, gpointer user_d
 static gboolean editor_check_colourise(GeanyEditor *editor)
 {
 	GeanyDocument *doc = editor->document;
+	gint64 start;
 
 	if (!doc->priv->colourise_needed)
 		return FALSE;
 
 	doc->priv->colourise_needed = FALSE;
+	start = perf_log_begin();
 	sci_colourise(editor->sci, 0, -1);
+	perf_log_end(PERF_STAGE_COLOURISE, start, doc->id, -1);
 
 	/* now that the current document is colourised, fold points are now accurate,
 	 * so force an update of the current function/tag. */
@@ -5029,6 +5055,54 @@ ScintillaObject *editor_create_widget(GeanyEditor *editor)
 }
 
 
+/** Creates a new Scintilla @c GtkWidget showing the same document as @a editor.
+ * The new view shares the Scintilla document with @c editor->sci, including its lexer,
+ * keywords, indicators and the styling already done, so the text is not lexed again.
+ * Only the per-view settings (colours, markers, margins, ...) are applied to it.
+ * @param editor Editor whose document to show.
+ * @return @transfer{floating} The new widget.
+ *
+ * @see editor_update_view().
+ *
+ * @since 2.2
+ **/
+GEANY_API_SYMBOL
+ScintillaObject *editor_create_view(GeanyEditor *editor)
+{
+	ScintillaObject *sci;
+
+	g_return_val_if_fail(editor != NULL && editor->sci != NULL, NULL);
+
+	sci = editor_create_widget(editor);
+	editor_update_view(editor, sci);
+	return sci;
+}
+
+
+/** Attaches @a sci to the document of @a editor if necessary and refreshes its
+ * per-view settings, e.g. after the filetype of the document changed.
+ * The document's lexer state is reused, see editor_create_view().
+ * @param editor Editor whose document to show.
+ * @param sci A view created with editor_create_view().
+ *
+ * @since 2.2
+ **/
+GEANY_API_SYMBOL
+void editor_update_view(GeanyEditor *editor, ScintillaObject *sci)
+{
+	sptr_t sdoc;
+
+	g_return_if_fail(editor != NULL && editor->sci != NULL);
+	g_return_if_fail(IS_SCINTILLA(sci) && sci != editor->sci);
+
+	sdoc = SSM(editor->sci, SCI_GETDOCPOINTER, 0, 0);
+	if (SSM(sci, SCI_GETDOCPOINTER, 0, 0) != sdoc)
+		SSM(sci, SCI_SETDOCPOINTER, 0, sdoc);
+
+	highlighting_set_view_styles(sci, editor->document->file_type);
+}
+
+
 GeanyEditor *editor_create(GeanyDocument *doc)
 {
 	const GeanyIndentPrefs *iprefs = get_default_indent_prefs();
@@ -169,6 +169,10 @@ const GeanyIndentPrefs *editor_get_indent_prefs(GeanyEditor *editor);
 
 ScintillaObject *editor_create_widget(GeanyEditor *editor);
 
+ScintillaObject *editor_create_view(GeanyEditor *editor);
+
+void editor_update_view(GeanyEditor *editor, ScintillaObject *sci);
+
 void editor_indicator_set_on_range(GeanyEditor *editor, gint indic, gint start, gint end);
 
 void editor_indicator_set_on_line(GeanyEditor *editor, gint indic, gint line);
@@ -59,6 +59,25 @@ GPtrArray *filetypes_array = NULL;
 static GHashTable *filetypes_hash = NULL;	/* Hash of filetype pointers based on name keys */
 GSList *filetypes_by_title = NULL;
 
+/* A filetype pattern, by index into filetypes_array and ft->pattern */
+typedef struct
+{
+	guint ft_idx;
+	guint pattern_idx;
+} PatternRef;
+
+/* The filetype patterns compiled for filetypes_detect_from_extension(), so
+ * that detecting a file doesn't wildcard-match every pattern of every filetype.
+ * Rebuilt whenever the patterns are read. */
+static struct
+{
+	GHashTable *suffixes;	/* "*.ext" patterns keyed by ".ext", GArray of PatternRef */
+	GHashTable *names;		/* patterns without wildcards, GArray of PatternRef */
+	GArray *others;			/* all remaining patterns, PatternRef */
+	gchar *conf_prefixes[2];	/* locale-encoded filetype definition paths */
+}
+detect_table;
+
 
 static void create_radio_menu_item(GtkWidget *menu, GeanyFiletype *ftype);
 
@@ -511,28 +530,72 @@ void filetypes_init(void)
 }
 
 
-static guint match_basename(const GeanyFiletype *ft, const gchar *base_filename)
+static void add_pattern_ref(GHashTable *table, const gchar *key, const PatternRef *ref)
 {
-	if (G_UNLIKELY(ft->id == GEANY_FILETYPES_NONE))
-		return 0;
+	GArray *refs = g_hash_table_lookup(table, key);
+
+	if (!refs)
+	{
+		refs = g_array_new(FALSE, FALSE, sizeof(PatternRef));
+		g_hash_table_insert(table, g_strdup(key), refs);
+	}
+	g_array_append_val(refs, *ref);
+}
+
 
-	for (guint j = 0; ft->pattern[j] != NULL; j++)
+static void free_detect_table(void)
+{
+	if (detect_table.suffixes)
 	{
-		gchar *pat = ft->pattern[j];
-		
-		if (g_pattern_match_simple(pat, base_filename))
+		g_hash_table_destroy(detect_table.suffixes);
+		g_hash_table_destroy(detect_table.names);
+		g_array_free(detect_table.others, TRUE);
+	}
+	g_free(detect_table.conf_prefixes[0]);
+	g_free(detect_table.conf_prefixes[1]);
+	memset(&detect_table, 0, sizeof detect_table);
+}
+
+
+static void build_detect_table(void)
+{
+	free_detect_table();
+
+	detect_table.suffixes = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+		(GDestroyNotify) g_array_unref);
+	detect_table.names = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+		(GDestroyNotify) g_array_unref);
+	detect_table.others = g_array_new(FALSE, FALSE, sizeof(PatternRef));
+
+	for (guint i = 0; i < filetypes_array->len; i++)
+	{
+		if (filetypes[i]->id == GEANY_FILETYPES_NONE)
+			continue;
+
+		for (guint j = 0; filetypes[i]->pattern[j] != NULL; j++)
 		{
-			return strlen(pat);
+			const gchar *pat = filetypes[i]->pattern[j];
+			PatternRef ref = { i, j };
+
+			if (strpbrk(pat, "*?") == NULL)
+				add_pattern_ref(detect_table.names, pat, &ref);
+			else if (pat[0] == '*' && pat[1] == '.' && strpbrk(pat + 1, "*?") == NULL)
+				add_pattern_ref(detect_table.suffixes, pat + 1, &ref);
+			else
+				g_array_append_val(detect_table.others, ref);
 		}
 	}
-	return 0;
+
+	detect_table.conf_prefixes[0] = g_build_filename(app->configdir, GEANY_FILEDEFS_SUBDIR,
+		"filetypes.", NULL);
+	detect_table.conf_prefixes[1] = g_build_filename(app->datadir, GEANY_FILEDEFS_SUBDIR,
+		"filetypes.", NULL);
 }
 
 
 static GeanyFiletype *detect_filetype_conf_file(const gchar *utf8_filename)
 {
 	gchar *lfn = NULL;
-	gchar *path;
 	gboolean found = FALSE;
 
 #ifdef G_OS_WIN32
@@ -543,20 +606,37 @@ static GeanyFiletype *detect_filetype_conf_file(const gchar *utf8_filename)
 #endif
 	SETPTR(lfn, utils_get_locale_from_utf8(lfn));
 
-	path = g_build_filename(app->configdir, GEANY_FILEDEFS_SUBDIR, "filetypes.", NULL);
-	if (g_str_has_prefix(lfn, path))
-		found = TRUE;
-
-	SETPTR(path, g_build_filename(app->datadir, GEANY_FILEDEFS_SUBDIR, "filetypes.", NULL));
-	if (g_str_has_prefix(lfn, path))
-		found = TRUE;
+	for (guint i = 0; i < G_N_ELEMENTS(detect_table.conf_prefixes); i++)
+	{
+		if (g_str_has_prefix(lfn, detect_table.conf_prefixes[i]))
+			found = TRUE;
+	}
 
-	g_free(path);
 	g_free(lfn);
 	return found ? filetypes[GEANY_FILETYPES_CONF] : NULL;
 }
 
 
+static void append_pattern_refs(GArray *matches, GHashTable *table, const gchar *key)
+{
+	GArray *refs = g_hash_table_lookup(table, key);
+
+	if (refs)
+		g_array_append_vals(matches, refs->data, refs->len);
+}
+
+
+static gint cmp_pattern_ref(gconstpointer a, gconstpointer b)
+{
+	const PatternRef *ra = a;
+	const PatternRef *rb = b;
+
+	if (ra->ft_idx != rb->ft_idx)
+		return ra->ft_idx < rb->ft_idx ? -1 : 1;
+	return ra->pattern_idx < rb->pattern_idx ? -1 : (ra->pattern_idx > rb->pattern_idx);
+}
+
+
 /* Detect filetype only based on the filename extension.
  * utf8_filename can include the full path.
  * Returns: non-NULL */
@@ -564,6 +644,7 @@ GeanyFiletype *filetypes_detect_from_extension(const gchar *utf8_filename)
 {
 	gchar *base_filename;
 	GeanyFiletype *ft;
+	GArray *matches;
 	guint plen = 0;
 
 	ft = detect_filetype_conf_file(utf8_filename);
@@ -577,21 +658,45 @@ GeanyFiletype *filetypes_detect_from_extension(const gchar *utf8_filename)
 	SETPTR(base_filename, g_utf8_strdown(base_filename, -1));
 #endif
 
-	for (guint i = 0; i < filetypes_array->len; i++)
+	/* collect the matching patterns: exact names and "*.ext" suffixes by lookup,
+	 * only the remaining patterns need wildcard matching */
+	matches = g_array_new(FALSE, FALSE, sizeof(PatternRef));
+	append_pattern_refs(matches, detect_table.names, base_filename);
+	for (const gchar *dot = strchr(base_filename, '.'); dot; dot = strchr(dot + 1, '.'))
+		append_pattern_refs(matches, detect_table.suffixes, dot);
+	for (guint i = 0; i < detect_table.others->len; i++)
 	{
-		guint mlen = match_basename(filetypes[i], base_filename);
-		
+		PatternRef *ref = &g_array_index(detect_table.others, PatternRef, i);
+
+		if (g_pattern_match_simple(filetypes[ref->ft_idx]->pattern[ref->pattern_idx], base_filename))
+			g_array_append_val(matches, *ref);
+	}
+	/* in filetype order; only the first matching pattern of a filetype counts */
+	g_array_sort(matches, cmp_pattern_ref);
+
+	for (guint i = 0; i < matches->len; i++)
+	{
+		PatternRef *ref = &g_array_index(matches, PatternRef, i);
+		GeanyFiletype *match = filetypes[ref->ft_idx];
+		guint mlen;
+
+		if (i > 0 && g_array_index(matches, PatternRef, i - 1).ft_idx == ref->ft_idx)
+			continue;
+
+		mlen = strlen(match->pattern[ref->pattern_idx]);
 		if (mlen > plen)
 		{	// longest pattern match wins
 			plen = mlen;
-			ft = filetypes[i];
+			ft = match;
 		}
 		else if (mlen == plen && ft && !ft->priv->user_extensions &&
-			filetypes[i]->priv->user_extensions)
+			match->priv->user_extensions)
 		{	// user config overrides system if pattern len same
-			ft = filetypes[i];
+			ft = match;
 		}
 	}
+	g_array_free(matches, TRUE);
+
 	if (ft == NULL)
 		ft = filetypes[GEANY_FILETYPES_NONE];
 
@@ -909,6 +1014,7 @@ void filetypes_free_types(void)
 	g_return_if_fail(filetypes_array != NULL);
 	g_return_if_fail(filetypes_hash != NULL);
 
+	free_detect_table();
 	g_ptr_array_foreach(filetypes_array, filetype_free, NULL);
 	g_ptr_array_free(filetypes_array, TRUE);
 	g_hash_table_destroy(filetypes_hash);
@@ -1486,6 +1592,7 @@ static void read_filetype_config(void)
 	g_key_file_load_from_file(userconfig, userconfigfile, G_KEY_FILE_NONE, NULL);
 
 	read_extensions(sysconfig, userconfig);
+	build_detect_table();
 
 	g_free(sysconfigfile);
 	g_free(userconfigfile);
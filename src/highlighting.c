@@ -609,13 +609,16 @@ static void set_character_classes(ScintillaObject *sci, guint ft_id)
 }
 
 
-static void styleset_common(ScintillaObject *sci, guint ft_id)
+/* @a view_only skips the settings stored in the Scintilla document (character classes and
+ * lexer properties), which are shared by all views of the document. */
+static void styleset_common(ScintillaObject *sci, guint ft_id, gboolean view_only)
 {
 	GeanyLexerStyle *style;
 
 	SSM(sci, SCI_STYLECLEARALL, 0, 0);
 
-	set_character_classes(sci, ft_id);
+	if (! view_only)
+		set_character_classes(sci, ft_id);
 
 	/* caret colour, style and width */
 	SSM(sci, SCI_SETCARETFORE, invert(common_style_set.styling[GCS_CARET].foreground), 0);
@@ -767,11 +770,14 @@ static void styleset_common(ScintillaObject *sci, guint ft_id)
 	}
 
 	/* set some common defaults */
-	sci_set_property(sci, "fold", "1");
-	sci_set_property(sci, "fold.compact", "0");
-	sci_set_property(sci, "fold.comment", "1");
-	sci_set_property(sci, "fold.preprocessor", "1");
-	sci_set_property(sci, "fold.at.else", "1");
+	if (! view_only)
+	{
+		sci_set_property(sci, "fold", "1");
+		sci_set_property(sci, "fold.compact", "0");
+		sci_set_property(sci, "fold.comment", "1");
+		sci_set_property(sci, "fold.preprocessor", "1");
+		sci_set_property(sci, "fold.at.else", "1");
+	}
 
 	style = &common_style_set.styling[GCS_SELECTION];
 	if (!style->bold && !style->italic)
@@ -853,21 +859,25 @@ static void styleset_init_from_mapping(guint ft_id, GKeyFile *config, GKeyFile *
 }
 
 
-/* STYLE_DEFAULT will be set to match the first style. */
+/* STYLE_DEFAULT will be set to match the first style.
+ * If @a view_only is set, the lexer, keywords and properties are left alone because they
+ * belong to the Scintilla document and would trigger a full restyle. */
 static void styleset_from_mapping(ScintillaObject *sci, guint ft_id, guint lexer,
 		const HLStyle *styles, gsize n_styles,
 		const HLKeyword *keywords, gsize n_keywords,
-		const HLProperty *properties, gsize n_properties)
+		const HLProperty *properties, gsize n_properties,
+		gboolean view_only)
 {
 	gsize i;
 
 	g_assert(ft_id != GEANY_FILETYPES_NONE);
 
 	/* lexer */
-	sci_set_lexer(sci, lexer);
+	if (! view_only)
+		sci_set_lexer(sci, lexer);
 
 	/* styles */
-	styleset_common(sci, ft_id);
+	styleset_common(sci, ft_id, view_only);
 	if (n_styles > 0)
 	{
 		/* first style is also default one */
@@ -880,6 +890,9 @@ static void styleset_from_mapping(ScintillaObject *sci, guint ft_id, guint lexer
 		}
 	}
 
+	if (view_only)
+		return;
+
 	/* keywords */
 	foreach_range(i, n_keywords)
 	{
@@ -896,14 +909,15 @@ static void styleset_from_mapping(ScintillaObject *sci, guint ft_id, guint lexer
 
 
 
-static void styleset_default(ScintillaObject *sci, guint ft_id)
+static void styleset_default(ScintillaObject *sci, guint ft_id, gboolean view_only)
 {
-	sci_set_lexer(sci, SCLEX_NULL);
+	if (! view_only)
+		sci_set_lexer(sci, SCLEX_NULL);
 
 	/* we need to set STYLE_DEFAULT before we call SCI_STYLECLEARALL in styleset_common() */
 	set_sci_style(sci, STYLE_DEFAULT, GEANY_FILETYPES_NONE, GCS_DEFAULT);
 
-	styleset_common(sci, ft_id);
+	styleset_common(sci, ft_id, view_only);
 }
 
 
@@ -1084,14 +1098,11 @@ void highlighting_init_styles(guint filetype_idx, GKeyFile *config, GKeyFile *co
 				highlighting_keywords_##LANG_NAME, \
 				HL_N_ENTRIES(highlighting_keywords_##LANG_NAME), \
 				highlighting_properties_##LANG_NAME, \
-				HL_N_ENTRIES(highlighting_properties_##LANG_NAME)); \
+				HL_N_ENTRIES(highlighting_properties_##LANG_NAME), \
+				view_only); \
 		break
 
-/** Sets up highlighting and other visual settings.
- * @param sci Scintilla widget.
- * @param ft Filetype settings to use. */
-GEANY_API_SYMBOL
-void highlighting_set_styles(ScintillaObject *sci, GeanyFiletype *ft)
+static void set_styles(ScintillaObject *sci, GeanyFiletype *ft, gboolean view_only)
 {
 	guint lexer_id = get_lexer_filetype(ft);
 
@@ -1167,10 +1178,10 @@ void highlighting_set_styles(ScintillaObject *sci, GeanyFiletype *ft)
 		styleset_case(ZIG);
 		case GEANY_FILETYPES_NONE:
 		default:
-			styleset_default(sci, ft->id);
+			styleset_default(sci, ft->id, view_only);
 	}
 	/* [lexer_properties] settings */
-	if (style_sets[ft->id].property_keys)
+	if (! view_only && style_sets[ft->id].property_keys)
 	{
 		gchar **prop = style_sets[ft->id].property_keys;
 		gchar **val = style_sets[ft->id].property_values;
@@ -1185,6 +1196,25 @@ void highlighting_set_styles(ScintillaObject *sci, GeanyFiletype *ft)
 }
 
 
+/** Sets up highlighting and other visual settings.
+ * @param sci Scintilla widget.
+ * @param ft Filetype settings to use. */
+GEANY_API_SYMBOL
+void highlighting_set_styles(ScintillaObject *sci, GeanyFiletype *ft)
+{
+	set_styles(sci, ft, FALSE);
+}
+
+
+/* Like highlighting_set_styles(), but only applies the per-view settings (style colours,
+ * indicators, markers, ...) for a widget sharing its document with another one.
+ * The document's lexer, keywords and styling are kept, so nothing is re-lexed. */
+void highlighting_set_view_styles(ScintillaObject *sci, GeanyFiletype *ft)
+{
+	set_styles(sci, ft, TRUE);
+}
+
+
 /** Retrieves a style @a style_id for the filetype @a ft_id.
  * If the style was not already initialised
  * (e.g. by by opening a file of this type), it will be initialised. The returned pointer is
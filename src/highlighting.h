@@ -58,6 +58,8 @@ gboolean highlighting_is_code_style(gint lexer, gint style);
 
 void highlighting_init_styles(guint filetype_idx, GKeyFile *config, GKeyFile *configh);
 
+void highlighting_set_view_styles(ScintillaObject *sci, GeanyFiletype *ft);
+
 void highlighting_free_styles(void);
 
 void highlighting_show_color_scheme_dialog(void);
@@ -336,6 +336,10 @@ static void init_pref_groups(void)
 		"reload_clean_doc_on_file_change", FALSE);
 	stash_group_add_boolean(group, &file_prefs.save_config_on_file_change,
 		"save_config_on_file_change", TRUE);
+	stash_group_add_integer(group, &file_prefs.undo_memory_limit,
+		"undo_memory_limit", 64);
+	stash_group_add_integer(group, &file_prefs.undo_memory_limit_total,
+		"undo_memory_limit_total", 256);
 	stash_group_add_string(group, &file_prefs.extract_filetype_regex,
 		"extract_filetype_regex", GEANY_DEFAULT_FILETYPE_REGEX);
 	stash_group_add_boolean(group, &ui_prefs.allow_always_save,
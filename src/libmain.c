@@ -45,6 +45,7 @@
 #include "msgwindow.h"
 #include "navqueue.h"
 #include "notebook.h"
+#include "perflog.h"
 #include "plugins.h"
 #include "projectprivate.h"
 #include "prefs.h"
@@ -113,6 +114,7 @@ static gboolean print_prefix = FALSE;
 #ifdef HAVE_PLUGINS
 static gboolean no_plugins = FALSE;
 #endif
+static gchar *perf_log_file = NULL;
 static gboolean dummy = FALSE;
 
 /* in alphabetical order of short options */
@@ -134,6 +136,7 @@ static GOptionEntry entries[] =
 #ifdef HAVE_PLUGINS
 	{ "no-plugins", 'p', 0, G_OPTION_ARG_NONE, &no_plugins, N_("Don't load plugins"), NULL },
 #endif
+	{ "perf-log", 0, 0, G_OPTION_ARG_FILENAME, &perf_log_file, N_("Record editor latencies and write them to FILE as a Chrome trace on exit"), N_("FILE") },
 	{ "print-prefix", 0, 0, G_OPTION_ARG_NONE, &print_prefix, N_("Print Geany's installation prefix"), NULL },
 	{ "read-only", 'r', 0, G_OPTION_ARG_NONE, &cl_options.readonly, N_("Open all FILES in read-only mode (see documentation)"), NULL },
 	{ "no-session", 's', G_OPTION_FLAG_REVERSE, G_OPTION_ARG_NONE, &cl_options.load_session, N_("Don't load the previous session's files"), NULL },
@@ -1154,6 +1157,11 @@ gint main_lib(gint argc, gchar **argv)
 	geany_object = geany_object_new();
 
 	/* inits */
+	if (perf_log_file)
+	{
+		perf_log_init(perf_log_file);
+		g_free(perf_log_file);
+	}
 	main_init();
 
 	encodings_init();
@@ -1330,6 +1338,7 @@ static gboolean do_main_quit(void)
 	sidebar_finalize();
 	configuration_finalize();
 	filetypes_free_types();
+	perf_log_finalize();
 	log_finalize();
 
 	tm_workspace_free();
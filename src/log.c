@@ -29,6 +29,7 @@
 #include "log.h"
 
 #include "app.h"
+#include "perflog.h"
 #include "support.h"
 #include "utils.h"
 #include "ui_utils.h"
@@ -44,7 +45,8 @@ static GtkTextBuffer *dialog_textbuffer = NULL;
 
 enum
 {
-	DIALOG_RESPONSE_CLEAR = 1
+	DIALOG_RESPONSE_CLEAR = 1,
+	DIALOG_RESPONSE_PERFORMANCE
 };
 
 
@@ -170,6 +172,24 @@ static void on_dialog_response(GtkDialog *dialog, gint response, gpointer user_d
 
 		g_string_erase(log_buffer, 0, -1);
 	}
+	else if (response == DIALOG_RESPONSE_PERFORMANCE)
+	{
+		const gchar *trace_file = perf_log_get_trace_file();
+		gchar *summary = perf_log_get_summary();
+		GError *error = NULL;
+
+		/* append the latency summary and save the trace recorded so far */
+		g_string_append_printf(log_buffer, "\n%s", summary);
+		if (! perf_log_write_trace(trace_file, &error))
+		{
+			g_string_append_printf(log_buffer, _("Could not write %s: %s\n"), trace_file, error->message);
+			g_error_free(error);
+		}
+		else
+			g_string_append_printf(log_buffer, _("Trace written to %s\n"), trace_file);
+		g_free(summary);
+		update_dialog();
+	}
 	else
 	{
 		gtk_widget_destroy(GTK_WIDGET(dialog));
@@ -189,6 +209,8 @@ void log_show_debug_messages_dialog(void)
 	vbox = ui_dialog_vbox_new(GTK_DIALOG(dialog));
 	gtk_box_set_spacing(GTK_BOX(vbox), 6);
 	gtk_widget_set_name(dialog, "GeanyDialog");
+	if (perf_log_is_enabled())
+		gtk_dialog_add_button(GTK_DIALOG(dialog), _("_Performance"), DIALOG_RESPONSE_PERFORMANCE);
 
 	gtk_window_set_default_size(GTK_WINDOW(dialog), 550, 300);
 	gtk_dialog_set_default_response(GTK_DIALOG(dialog), GTK_RESPONSE_CLOSE);
@@ -40,6 +40,7 @@
 #include "main.h"
 #include "navqueue.h"
 #include "prefs.h"
+#include "search.h"
 #include "support.h"
 #include "ui_utils.h"
 #include "utils.h"
@@ -1327,6 +1328,8 @@ void msgwin_clear_tab(gint tabnum)
 	switch (tabnum)
 	{
 		case MSG_MESSAGE:
+			/* don't keep adding results of a running search */
+			search_find_usage_cancel();
 			store = msgwindow.store_msg;
 			break;
 
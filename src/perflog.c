@@ -0,0 +1,330 @@
+/*
+ *      perflog.c - this file is part of Geany, a fast and lightweight IDE
+ *
+ *      Copyright 2026 The Geany contributors
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Latency tracing of editor stages, enabled with --perf-log.
+ *
+ * Every traced stage is recorded into a fixed size ring buffer and a per-stage log2
+ * histogram. Recording only uses atomic operations, so it is cheap enough to stay
+ * enabled while typing and could be used from worker threads too. The ring buffer
+ * keeps the most recent events, which can be written as a Chrome trace
+ * (chrome://tracing, Perfetto) at exit or from the Debug Messages dialog.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "perflog.h"
+
+#include "document.h"
+#include "geanyobject.h"
+#include "utils.h"
+
+#include <glib.h>
+
+
+#define PERF_RING_SIZE 65536	/* power of 2 */
+#define PERF_RING_MASK (PERF_RING_SIZE - 1)
+/* bucket n counts durations below 2^n µs, the last one everything above */
+#define PERF_BUCKETS 24
+
+
+typedef struct
+{
+	gint seq;		/* index + 1 of the stored event, 0 while it is written */
+	gint stage;
+	gint code;
+	guint doc_id;
+	gint64 start;	/* µs since tracing started */
+	gint64 duration;
+} PerfEvent;
+
+typedef struct
+{
+	gint buckets[PERF_BUCKETS];
+	gint max_us;
+	gsize total_us;
+} PerfHistogram;
+
+
+static const gchar *stage_names[PERF_STAGE_COUNT] =
+{
+	"editor-notify",
+	"on_editor_notify",
+	"update-tags",
+	"symbol-list",
+	"highlight-tags",
+	"colourise",
+	"brace-match"
+};
+
+static gboolean perf_enabled = FALSE;
+static gchar *perf_trace_file = NULL;
+static gint64 perf_epoch;
+static PerfEvent *perf_ring = NULL;
+static gint perf_head = 0;
+static PerfHistogram perf_histograms[PERF_STAGE_COUNT];
+/* names of closed documents, so that their events can still be labelled */
+static GHashTable *closed_documents = NULL;
+
+
+static void on_document_close(G_GNUC_UNUSED GObject *obj, GeanyDocument *doc,
+		G_GNUC_UNUSED gpointer user_data)
+{
+	if (doc->file_name != NULL)
+		g_hash_table_insert(closed_documents, GUINT_TO_POINTER(doc->id), g_strdup(doc->file_name));
+}
+
+
+/* Starts tracing, @a trace_file is written on exit if not NULL */
+void perf_log_init(const gchar *trace_file)
+{
+	perf_ring = g_new0(PerfEvent, PERF_RING_SIZE);
+	perf_trace_file = g_strdup(trace_file);
+	perf_epoch = g_get_monotonic_time();
+	perf_enabled = TRUE;
+
+	closed_documents = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+	g_signal_connect(geany_object, "document-close", G_CALLBACK(on_document_close), NULL);
+}
+
+
+void perf_log_finalize(void)
+{
+	if (! perf_enabled)
+		return;
+
+	if (perf_trace_file != NULL)
+	{
+		gchar *summary = perf_log_get_summary();
+		GError *error = NULL;
+
+		if (! perf_log_write_trace(perf_trace_file, &error))
+		{
+			g_warning("Could not write %s: %s", perf_trace_file, error->message);
+			g_error_free(error);
+		}
+		g_printerr("%s", summary);
+		g_free(summary);
+	}
+
+	perf_enabled = FALSE;
+	g_signal_handlers_disconnect_by_func(geany_object, G_CALLBACK(on_document_close), NULL);
+	g_hash_table_destroy(closed_documents);
+	closed_documents = NULL;
+	g_free(perf_ring);
+	perf_ring = NULL;
+	SETPTR(perf_trace_file, NULL);
+}
+
+
+gboolean perf_log_is_enabled(void)
+{
+	return perf_enabled;
+}
+
+
+const gchar *perf_log_get_trace_file(void)
+{
+	return perf_trace_file;
+}
+
+
+/* Returns the start time to pass to perf_log_end(), 0 if tracing is disabled */
+gint64 perf_log_begin(void)
+{
+	return G_UNLIKELY(perf_enabled) ? g_get_monotonic_time() : 0;
+}
+
+
+static void histogram_add(PerfHistogram *histogram, gint64 duration)
+{
+	gint us = (gint) MIN(duration, G_MAXINT);
+	guint bucket = us > 0 ? MIN(g_bit_storage((gulong) us), PERF_BUCKETS - 1) : 0;
+	gint max;
+
+	g_atomic_int_inc(&histogram->buckets[bucket]);
+	g_atomic_pointer_add(&histogram->total_us, (gssize) us);
+	do
+		max = g_atomic_int_get(&histogram->max_us);
+	while (us > max && ! g_atomic_int_compare_and_exchange(&histogram->max_us, max, us));
+}
+
+
+/* Records a stage that started at @a start, @a code is the notification code
+ * or -1 */
+void perf_log_end(PerfStage stage, gint64 start, guint doc_id, gint code)
+{
+	gint64 duration;
+	PerfEvent *event;
+	gint index;
+
+	if (start == 0 || ! perf_enabled)
+		return;
+
+	duration = g_get_monotonic_time() - start;
+	histogram_add(&perf_histograms[stage], duration);
+
+	/* claim a slot; readers skip it until seq is set again */
+	index = g_atomic_int_add(&perf_head, 1);
+	event = &perf_ring[index & PERF_RING_MASK];
+	g_atomic_int_set(&event->seq, 0);
+	event->stage = stage;
+	event->code = code;
+	event->doc_id = doc_id;
+	event->start = start - perf_epoch;
+	event->duration = duration;
+	g_atomic_int_set(&event->seq, index + 1);
+}
+
+
+/* Upper bound of the bucket containing the @a percent percentile, in µs */
+static guint64 histogram_percentile(const gint *buckets, guint count, guint percent)
+{
+	guint64 needed = ((guint64) count * percent + 99) / 100;
+	guint64 seen = 0;
+	guint i;
+
+	for (i = 0; i < PERF_BUCKETS; i++)
+	{
+		seen += buckets[i];
+		if (seen >= needed)
+			break;
+	}
+	return (guint64) 1 << MIN(i, PERF_BUCKETS - 1);
+}
+
+
+/* Returns a human readable table and histogram of each stage, in µs */
+gchar *perf_log_get_summary(void)
+{
+	GString *str = g_string_new(NULL);
+	guint stage, i;
+
+	g_string_append_printf(str, "%-18s %8s %10s %9s %9s %9s %9s %9s\n",
+		"stage", "count", "total ms", "mean µs", "p50 µs", "p90 µs", "p99 µs", "max µs");
+
+	for (stage = 0; stage < PERF_STAGE_COUNT; stage++)
+	{
+		PerfHistogram *histogram = &perf_histograms[stage];
+		gint buckets[PERF_BUCKETS];
+		guint count = 0, peak = 0;
+		gsize total = (gsize) g_atomic_pointer_get(&histogram->total_us);
+
+		for (i = 0; i < PERF_BUCKETS; i++)
+		{
+			buckets[i] = g_atomic_int_get(&histogram->buckets[i]);
+			count += buckets[i];
+			peak = MAX(peak, (guint) buckets[i]);
+		}
+		if (count == 0)
+			continue;
+
+		g_string_append_printf(str, "%-18s %8u %10.1f %9" G_GSIZE_FORMAT
+			" %9" G_GUINT64_FORMAT " %9" G_GUINT64_FORMAT " %9" G_GUINT64_FORMAT " %9d\n",
+			stage_names[stage], count, total / 1000.0, total / count,
+			histogram_percentile(buckets, count, 50), histogram_percentile(buckets, count, 90),
+			histogram_percentile(buckets, count, 99), g_atomic_int_get(&histogram->max_us));
+
+		for (i = 0; i < PERF_BUCKETS; i++)
+		{
+			gchar *bar;
+
+			if (buckets[i] == 0)
+				continue;
+			bar = g_strnfill(MAX(1, (gsize) buckets[i] * 40 / peak), '#');
+			if (i + 1 < PERF_BUCKETS)
+				g_string_append_printf(str, "    < %8lu µs %8d %s\n", 1UL << i, buckets[i], bar);
+			else
+				g_string_append_printf(str, "    >= %7lu µs %8d %s\n", 1UL << (i - 1), buckets[i], bar);
+			g_free(bar);
+		}
+	}
+	return g_string_free(str, FALSE);
+}
+
+
+static void append_json_string(GString *str, const gchar *value)
+{
+	const gchar *p;
+
+	g_string_append_c(str, '"');
+	for (p = value; *p; p++)
+	{
+		if (*p == '"' || *p == '\\')
+			g_string_append_printf(str, "\\%c", *p);
+		else if ((guchar) *p < 0x20)
+			g_string_append_printf(str, "\\u%04x", (guchar) *p);
+		else
+			g_string_append_c(str, *p);
+	}
+	g_string_append_c(str, '"');
+}
+
+
+/* Writes the events in the ring buffer in the Chrome trace event format */
+gboolean perf_log_write_trace(const gchar *filename, GError **error)
+{
+	GString *str;
+	gboolean first = TRUE;
+	guint head, i;
+	gboolean ret;
+
+	g_return_val_if_fail(perf_enabled, FALSE);
+
+	str = g_string_sized_new(1024 * 1024);
+	g_string_append(str, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	head = (guint) g_atomic_int_get(&perf_head);
+	for (i = head > PERF_RING_SIZE ? head - PERF_RING_SIZE : 0; i != head; i++)
+	{
+		PerfEvent *slot = &perf_ring[i & PERF_RING_MASK];
+		PerfEvent event = *slot;
+		GeanyDocument *doc;
+		const gchar *file_name;
+
+		/* skip events being written or overwritten while we copied them */
+		if (event.seq != (gint) (i + 1) || g_atomic_int_get(&slot->seq) != event.seq)
+			continue;
+
+		g_string_append_printf(str, "%s{\"name\":\"%s\",\"cat\":\"editor\",\"ph\":\"X\","
+			"\"pid\":1,\"tid\":1,\"ts\":%" G_GINT64_FORMAT ",\"dur\":%" G_GINT64_FORMAT
+			",\"args\":{\"doc\":%u", first ? "" : ",\n", stage_names[event.stage],
+			event.start, event.duration, event.doc_id);
+		doc = event.doc_id ? document_find_by_id(event.doc_id) : NULL;
+		file_name = doc ? doc->file_name :
+			g_hash_table_lookup(closed_documents, GUINT_TO_POINTER(event.doc_id));
+		if (file_name != NULL)
+		{
+			g_string_append(str, ",\"file\":");
+			append_json_string(str, file_name);
+		}
+		if (event.code >= 0)
+			g_string_append_printf(str, ",\"code\":%d", event.code);
+		g_string_append(str, "}}");
+		first = FALSE;
+	}
+	g_string_append(str, "\n]}\n");
+
+	ret = g_file_set_contents(filename, str->str, str->len, error);
+	g_string_free(str, TRUE);
+	return ret;
+}
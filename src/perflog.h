@@ -0,0 +1,61 @@
+/*
+ *      perflog.h - this file is part of Geany, a fast and lightweight IDE
+ *
+ *      Copyright 2026 The Geany contributors
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef GEANY_PERFLOG_H
+#define GEANY_PERFLOG_H 1
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Editor stages whose latency is recorded with --perf-log */
+typedef enum
+{
+	PERF_STAGE_NOTIFY,			/* whole "editor-notify" emission, including plugins */
+	PERF_STAGE_EDITOR_NOTIFY,	/* Geany's own "editor-notify" handler */
+	PERF_STAGE_UPDATE_TAGS,
+	PERF_STAGE_SYMBOL_LIST,
+	PERF_STAGE_HIGHLIGHT_TAGS,
+	PERF_STAGE_COLOURISE,
+	PERF_STAGE_BRACE_MATCH,
+	PERF_STAGE_COUNT
+} PerfStage;
+
+
+void perf_log_init(const gchar *trace_file);
+
+void perf_log_finalize(void);
+
+gboolean perf_log_is_enabled(void);
+
+const gchar *perf_log_get_trace_file(void);
+
+gint64 perf_log_begin(void);
+
+void perf_log_end(PerfStage stage, gint64 start, guint doc_id, gint code);
+
+gchar *perf_log_get_summary(void);
+
+gboolean perf_log_write_trace(const gchar *filename, GError **error);
+
+G_END_DECLS
+
+#endif /* GEANY_PERFLOG_H */
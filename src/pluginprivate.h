@@ -40,6 +40,8 @@ typedef enum _LoadedFlags {
 	LOADED_OK = 0x01,
 	IS_LEGACY = 0x02,
 	LOAD_DATA = 0x04,
+	IS_CACHED = 0x08,	/* only the metadata from the plugin cache, the module isn't loaded */
+	IS_INCOMPATIBLE = 0x10,	/* failed the API/ABI version check */
 }
 LoadedFlags;
 
@@ -71,16 +73,26 @@ typedef struct GeanyPluginPrivate
 											 * this gives the proxy a pointer to each plugin */
 	gint			proxied_count;			/* count of active plugins this provides a proxy for
 											 * (a count because of possibly nested proxies) */
+
+	gboolean		deferred;				/* activation may be deferred until after startup */
+	gint64			load_time;				/* µs it took to load and initialize the plugin */
+	gint64			signal_time;			/* µs spent in signal handlers connected with
+											 * plugin_signal_connect() */
+	guint			signal_calls;
 }
 GeanyPluginPrivate;
 
 #define PLUGIN_LOADED_OK(p) (((p)->flags & LOADED_OK) != 0)
 #define PLUGIN_IS_LEGACY(p) (((p)->flags & IS_LEGACY) != 0)
 #define PLUGIN_HAS_LOAD_DATA(p) (((p)->flags & LOAD_DATA) != 0)
+#define PLUGIN_IS_CACHED(p) (((p)->flags & IS_CACHED) != 0)
+#define PLUGIN_IS_INCOMPATIBLE(p) (((p)->flags & IS_INCOMPATIBLE) != 0)
 
 void plugin_watch_object(Plugin *plugin, gpointer object);
 void plugin_make_resident(Plugin *plugin);
 gpointer plugin_get_module_symbol(Plugin *plugin, const gchar *sym);
+GClosure *plugin_signal_closure_new(Plugin *plugin, const gchar *signal_name,
+		GCallback callback, gpointer user_data);
 
 G_END_DECLS
 
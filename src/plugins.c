@@ -76,6 +76,9 @@ static gboolean want_plugins = FALSE;
 static GList *plugin_list = NULL;
 static gchar **active_plugins_pref = NULL; 	/* list of plugin filenames to load at startup */
 static GList *failed_plugins_list = NULL;	/* plugins the user wants active but can't be used */
+static gint signal_handler_budget = 50;		/* ms a signal handler may take before it's logged */
+static GList *deferred_plugins_list = NULL;	/* plugins to activate once the main window is shown */
+static guint deferred_plugins_source = 0;
 
 static GtkWidget *menu_separator = NULL;
 
@@ -243,11 +246,73 @@ plugin_check_version(Plugin *plugin, int plugin_version_code)
 		ret = FALSE;
 		g_free(name);
 	}
+	if (! ret)
+		plugin->flags |= IS_INCOMPATIBLE;
 
 	return ret;
 }
 
 
+typedef struct
+{
+	Plugin		*plugin;
+	const gchar	*signal_name;	/* interned */
+	gint64		start;
+	gint64		worst;			/* longest run logged so far */
+}
+SignalTiming;
+
+
+static void signal_timing_begin(gpointer data, G_GNUC_UNUSED GClosure *closure)
+{
+	SignalTiming *timing = data;
+
+	timing->start = g_get_monotonic_time();
+}
+
+
+static void signal_timing_end(gpointer data, G_GNUC_UNUSED GClosure *closure)
+{
+	SignalTiming *timing = data;
+	gint64 elapsed = g_get_monotonic_time() - timing->start;
+
+	timing->plugin->signal_time += elapsed;
+	timing->plugin->signal_calls++;
+
+	/* only log new worst times so a handler that is always slow doesn't flood the log */
+	if (signal_handler_budget > 0 && elapsed > signal_handler_budget * G_GINT64_CONSTANT(1000) &&
+		elapsed > timing->worst)
+	{
+		timing->worst = elapsed;
+		geany_debug("Plugin '%s' took %.1f ms to handle the \"%s\" signal",
+			timing->plugin->info.name, elapsed / 1000.0, timing->signal_name);
+	}
+}
+
+
+static void signal_timing_free(gpointer data, G_GNUC_UNUSED GClosure *closure)
+{
+	g_free(data);
+}
+
+
+/* Creates a closure for a signal handler of @a plugin that accounts the time spent in it
+ * to the plugin. The marshal guards are only run for the outermost invocation, so
+ * recursive emissions aren't counted twice. */
+GClosure *plugin_signal_closure_new(Plugin *plugin, const gchar *signal_name,
+		GCallback callback, gpointer user_data)
+{
+	GClosure *closure = g_cclosure_new(callback, user_data, NULL);
+	SignalTiming *timing = g_new0(SignalTiming, 1);
+
+	timing->plugin = plugin;
+	timing->signal_name = g_intern_string(signal_name);
+	g_closure_add_marshal_guards(closure, timing, signal_timing_begin, timing, signal_timing_end);
+	g_closure_add_finalize_notifier(closure, timing, signal_timing_free);
+	return closure;
+}
+
+
 static void add_callbacks(Plugin *plugin, PluginCallback *callbacks)
 {
 	PluginCallback *cb;
@@ -544,7 +609,6 @@ plugin_load(Plugin *plugin)
 	active_plugin_list = g_list_insert_sorted(active_plugin_list, plugin, cmp_plugin_names);
 	proxied_count_inc(plugin->proxy);
 
-	geany_debug("Loaded:   %s (%s)", plugin->filename, plugin->info.name);
 	return TRUE;
 }
 
@@ -605,6 +669,259 @@ static void plugin_unload_gmodule(GeanyPlugin *proxy, GeanyPlugin *subplugin, gp
 }
 
 
+/* Plugin cache
+ *
+ * Listing the available plugins in the Plugin Manager only needs their name, description
+ * etc., so these are cached by module filename together with the module's modification time
+ * and size. Only plugins that aren't in the cache or whose module changed are loaded to get
+ * them. The cache also remembers plugins that are incompatible with this Geany or lack a
+ * name and whether a plugin allows deferred activation, see plugin_set_deferred_activation().
+ * Other load failures, e.g. a missing library, are not cached as they might be temporary. */
+
+#define PLUGIN_CACHE_FILENAME "plugin_cache.conf"
+
+typedef struct
+{
+	gint64		mtime;
+	gint64		size;
+	gboolean	loadable;		/* FALSE if the module can't be loaded as a plugin */
+	gboolean	deferred;
+	gchar		*name;
+	gchar		*description;
+	gchar		*version;
+	gchar		*author;
+}
+PluginCacheEntry;
+
+static GHashTable *plugin_cache = NULL;	/* locale filename -> PluginCacheEntry */
+static gboolean plugin_cache_changed = FALSE;
+
+
+static void plugin_cache_entry_free(PluginCacheEntry *entry)
+{
+	g_free(entry->name);
+	g_free(entry->description);
+	g_free(entry->version);
+	g_free(entry->author);
+	g_free(entry);
+}
+
+
+static gboolean get_module_stamp(const gchar *fname, gint64 *mtime, gint64 *size)
+{
+	GStatBuf st;
+
+	if (g_stat(fname, &st) != 0)
+		return FALSE;
+
+	*mtime = st.st_mtime;
+	*size = st.st_size;
+	return TRUE;
+}
+
+
+static gchar *get_plugin_cache_filename(void)
+{
+	return g_build_filename(app->configdir, PLUGIN_CACHE_FILENAME, NULL);
+}
+
+
+static void plugin_cache_read(void)
+{
+	GKeyFile *config = g_key_file_new();
+	gchar *filename = get_plugin_cache_filename();
+	gchar **groups, **group;
+	gchar *locale;
+
+	plugin_cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+		(GDestroyNotify) plugin_cache_entry_free);
+
+	/* drop the whole cache when Geany's API changed, plugins might (not) load anymore */
+	if (! g_key_file_load_from_file(config, filename, G_KEY_FILE_NONE, NULL) ||
+		g_key_file_get_integer(config, "cache", "api_version", NULL) != GEANY_API_VERSION ||
+		g_key_file_get_integer(config, "cache", "abi_version", NULL) != GEANY_ABI_VERSION)
+	{
+		g_key_file_free(config);
+		g_free(filename);
+		return;
+	}
+	/* the cached names and descriptions are translated */
+	locale = g_key_file_get_string(config, "cache", "locale", NULL);
+	if (g_strcmp0(locale, g_get_language_names()[0]) != 0)
+	{
+		g_free(locale);
+		g_key_file_free(config);
+		g_free(filename);
+		return;
+	}
+	g_free(locale);
+
+	groups = g_key_file_get_groups(config, NULL);
+	foreach_strv(group, groups)
+	{
+		PluginCacheEntry *entry;
+		gchar *utf8_fname;
+
+		utf8_fname = g_key_file_get_string(config, *group, "filename", NULL);
+		if (utf8_fname == NULL)
+			continue;
+
+		entry = g_new0(PluginCacheEntry, 1);
+		entry->mtime = g_key_file_get_int64(config, *group, "mtime", NULL);
+		entry->size = g_key_file_get_int64(config, *group, "size", NULL);
+		entry->loadable = utils_get_setting_boolean(config, *group, "loadable", FALSE);
+		entry->deferred = utils_get_setting_boolean(config, *group, "deferred", FALSE);
+		entry->name = g_key_file_get_string(config, *group, "name", NULL);
+		entry->description = g_key_file_get_string(config, *group, "description", NULL);
+		entry->version = g_key_file_get_string(config, *group, "version", NULL);
+		entry->author = g_key_file_get_string(config, *group, "author", NULL);
+
+		if (entry->loadable && EMPTY(entry->name))
+			plugin_cache_entry_free(entry);
+		else
+			g_hash_table_insert(plugin_cache, utils_get_locale_from_utf8(utf8_fname), entry);
+		g_free(utf8_fname);
+	}
+	g_strfreev(groups);
+	g_key_file_free(config);
+	g_free(filename);
+}
+
+
+static void plugin_cache_write(void)
+{
+	GKeyFile *config;
+	GHashTableIter iter;
+	gpointer key, value;
+	gchar *filename, *data;
+	guint i = 0;
+
+	if (! plugin_cache_changed)
+		return;
+	plugin_cache_changed = FALSE;
+
+	config = g_key_file_new();
+	g_key_file_set_integer(config, "cache", "api_version", GEANY_API_VERSION);
+	g_key_file_set_integer(config, "cache", "abi_version", GEANY_ABI_VERSION);
+	g_key_file_set_string(config, "cache", "locale", g_get_language_names()[0]);
+
+	g_hash_table_iter_init(&iter, plugin_cache);
+	while (g_hash_table_iter_next(&iter, &key, &value))
+	{
+		PluginCacheEntry *entry = value;
+		gchar *group, *utf8_fname;
+
+		/* forget modules that have been removed */
+		if (! g_file_test(key, G_FILE_TEST_EXISTS))
+			continue;
+
+		group = g_strdup_printf("plugin%u", i++);
+		utf8_fname = utils_get_utf8_from_locale(key);
+		g_key_file_set_string(config, group, "filename", utf8_fname);
+		g_key_file_set_int64(config, group, "mtime", entry->mtime);
+		g_key_file_set_int64(config, group, "size", entry->size);
+		g_key_file_set_boolean(config, group, "loadable", entry->loadable);
+		if (entry->loadable)
+		{
+			g_key_file_set_boolean(config, group, "deferred", entry->deferred);
+			g_key_file_set_string(config, group, "name", entry->name);
+			g_key_file_set_string(config, group, "description",
+				entry->description ? entry->description : "");
+			g_key_file_set_string(config, group, "version",
+				entry->version ? entry->version : "");
+			g_key_file_set_string(config, group, "author",
+				entry->author ? entry->author : "");
+		}
+		g_free(utf8_fname);
+		g_free(group);
+	}
+
+	filename = get_plugin_cache_filename();
+	data = g_key_file_to_data(config, NULL, NULL);
+	utils_write_file(filename, data);
+	g_free(data);
+	g_free(filename);
+	g_key_file_free(config);
+}
+
+
+/* Returns the cache entry of the module @a fname if it is up to date, otherwise NULL */
+static PluginCacheEntry *plugin_cache_lookup(const gchar *fname)
+{
+	PluginCacheEntry *entry;
+	gint64 mtime, size;
+
+	if (plugin_cache == NULL)
+		plugin_cache_read();
+
+	entry = g_hash_table_lookup(plugin_cache, fname);
+	if (entry == NULL || ! get_module_stamp(fname, &mtime, &size) ||
+		entry->mtime != mtime || entry->size != size)
+		return NULL;
+	return entry;
+}
+
+
+static gboolean is_proxy_plugin(Plugin *plugin)
+{
+	GList *node;
+
+	foreach_list(node, active_proxies.head)
+	{
+		if (((PluginProxy *) node->data)->plugin == plugin)
+			return TRUE;
+	}
+	return FALSE;
+}
+
+
+/* Remembers the metadata of @a plugin, or that it isn't loadable if @a loadable is FALSE.
+ * @a initialized tells whether the plugin's init function has been called, only then
+ * it is known whether it is a proxy or allows deferred activation if it is a legacy plugin. */
+static void plugin_cache_store(Plugin *plugin, gboolean loadable, gboolean initialized)
+{
+	PluginCacheEntry *entry, *old;
+	gint64 mtime, size;
+
+	if (! get_module_stamp(plugin->filename, &mtime, &size))
+		return;
+
+	/* a proxied plugin might only fail because of its proxy's environment */
+	if (! loadable && plugin->proxy != &builtin_so_proxy_plugin)
+		return;
+
+	old = plugin_cache_lookup(plugin->filename);
+
+	entry = g_new0(PluginCacheEntry, 1);
+	entry->mtime = mtime;
+	entry->size = size;
+	entry->loadable = loadable;
+	if (loadable)
+	{
+		if (initialized)
+			entry->deferred = plugin->deferred && ! is_proxy_plugin(plugin);
+		else
+			entry->deferred = plugin->deferred || (old != NULL && old->deferred);
+		entry->name = g_strdup(plugin->info.name);
+		entry->description = g_strdup(plugin->info.description);
+		entry->version = g_strdup(plugin->info.version);
+		entry->author = g_strdup(plugin->info.author);
+	}
+
+	if (old != NULL && old->loadable == entry->loadable && old->deferred == entry->deferred &&
+		utils_str_equal(old->name, entry->name) &&
+		utils_str_equal(old->description, entry->description) &&
+		utils_str_equal(old->version, entry->version) &&
+		utils_str_equal(old->author, entry->author))
+	{
+		plugin_cache_entry_free(entry);
+		return;
+	}
+	g_hash_table_insert(plugin_cache, g_strdup(plugin->filename), entry);
+	plugin_cache_changed = TRUE;
+}
+
+
 /* Load and optionally init a plugin.
  * load_plugin decides whether the plugin's plugin_init() function should be called or not. If it is
  * called, the plugin will be started, if not the plugin will be read only (for the list of
@@ -614,6 +931,7 @@ static Plugin*
 plugin_new(Plugin *proxy, const gchar *fname, gboolean load_plugin, gboolean add_to_list)
 {
 	Plugin *plugin;
+	gint64 start;
 
 	g_return_val_if_fail(fname, NULL);
 	g_return_val_if_fail(proxy, NULL);
@@ -651,13 +969,40 @@ plugin_new(Plugin *proxy, const gchar *fname, gboolean load_plugin, gboolean add
 		goto err;
 	}
 
+	/* a plugin that is only listed can use the cached metadata without loading the module */
+	if (! load_plugin)
+	{
+		PluginCacheEntry *entry = plugin_cache_lookup(fname);
+
+		if (entry != NULL)
+		{
+			if (! entry->loadable)
+				goto err;
+
+			/* the strings are owned by the cache, which lives as long as plugin support */
+			plugin->info.name = entry->name;
+			plugin->info.description = entry->description;
+			plugin->info.version = entry->version;
+			plugin->info.author = entry->author;
+			plugin->flags = IS_CACHED;
+
+			if (add_to_list)
+				plugin_list = g_list_prepend(plugin_list, plugin);
+			return plugin;
+		}
+	}
+
 	/* Load plugin, this should read its name etc. It must also call
 	 * geany_plugin_register() for the following PLUGIN_LOADED_OK condition */
+	start = g_get_monotonic_time();
 	plugin->proxy_data = proxy->proxy_cbs.load(&proxy->public, &plugin->public, fname, proxy->cb_data);
 
 	if (! PLUGIN_LOADED_OK(plugin))
 	{
 		geany_debug("Failed to load \"%s\" - ignoring plugin!", fname);
+		/* only remember failures that won't go away until the module changes */
+		if (PLUGIN_IS_INCOMPATIBLE(plugin) || (plugin->proxy_data != NULL && EMPTY(plugin->info.name)))
+			plugin_cache_store(plugin, FALSE, FALSE);
 		goto err;
 	}
 
@@ -666,6 +1011,7 @@ plugin_new(Plugin *proxy, const gchar *fname, gboolean load_plugin, gboolean add
 	if (EMPTY(plugin->info.name))
 	{
 		geany_debug("No plugin name set for \"%s\" - ignoring plugin!", fname);
+		plugin_cache_store(plugin, FALSE, FALSE);
 		goto err_unload;
 	}
 
@@ -687,6 +1033,14 @@ plugin_new(Plugin *proxy, const gchar *fname, gboolean load_plugin, gboolean add
 		goto err_unload;
 	}
 
+	plugin_cache_store(plugin, TRUE, load_plugin);
+	if (load_plugin)
+	{
+		plugin->load_time = g_get_monotonic_time() - start;
+		geany_debug("Loaded:   %s (%s) in %.1f ms", plugin->filename, plugin->info.name,
+			plugin->load_time / 1000.0);
+	}
+
 	if (add_to_list)
 		plugin_list = g_list_prepend(plugin_list, plugin);
 
@@ -938,10 +1292,13 @@ plugin_free(Plugin *plugin)
 	active_plugin_list = g_list_remove(active_plugin_list, plugin);
 	plugin_list = g_list_remove(plugin_list, plugin);
 
-	/* cb_data_destroy might be plugin code and must be called before unloading the module. */
-	if (plugin->cb_data_destroy)
-		plugin->cb_data_destroy(plugin->cb_data);
-	proxy->proxy_cbs.unload(&proxy->public, &plugin->public, plugin->proxy_data, proxy->cb_data);
+	if (! PLUGIN_IS_CACHED(plugin))
+	{
+		/* cb_data_destroy might be plugin code and must be called before unloading the module. */
+		if (plugin->cb_data_destroy)
+			plugin->cb_data_destroy(plugin->cb_data);
+		proxy->proxy_cbs.unload(&proxy->public, &plugin->public, plugin->proxy_data, proxy->cb_data);
+	}
 
 	g_free(plugin->filename);
 	g_free(plugin);
@@ -1050,15 +1407,47 @@ static PluginProxy* is_plugin(const gchar *file)
 }
 
 
+/* Activates one deferred plugin per call so that the UI stays responsive */
+static gboolean activate_deferred_plugin(G_GNUC_UNUSED gpointer data)
+{
+	gchar *fname = deferred_plugins_list->data;
+
+	deferred_plugins_list = g_list_delete_link(deferred_plugins_list, deferred_plugins_list);
+
+	if (g_file_test(fname, G_FILE_TEST_EXISTS))
+	{
+		PluginProxy *proxy = NULL;
+
+		if (check_plugin_path(fname))
+			proxy = is_plugin(fname);
+		if (proxy == NULL || plugin_new(proxy->plugin, fname, TRUE, FALSE) == NULL)
+			failed_plugins_list = g_list_prepend(failed_plugins_list, g_strdup(fname));
+	}
+	g_free(fname);
+
+	if (deferred_plugins_list != NULL)
+		return TRUE;
+
+	/* load the shortcuts of the keybinding groups the plugins added */
+	keybindings_load_keyfile();
+	plugin_cache_write();
+	deferred_plugins_source = 0;
+	return FALSE;
+}
+
+
 /* load active plugins at startup */
 static void
 load_active_plugins(void)
 {
 	guint i, len, proxies;
+	gint64 start;
 
 	if (active_plugins_pref == NULL || (len = g_strv_length(active_plugins_pref)) == 0)
 		return;
 
+	start = g_get_monotonic_time();
+
 	/* If proxys are loaded we have to restart to load plugins that sort before their proxy */
 	do
 	{
@@ -1079,6 +1468,16 @@ load_active_plugins(void)
 			if (!EMPTY(fname) && g_file_test(fname, G_FILE_TEST_EXISTS))
 			{
 				PluginProxy *proxy = NULL;
+				PluginCacheEntry *entry = plugin_cache_lookup(fname);
+
+				/* plugins that allow it are activated once the main window is shown */
+				if (entry != NULL && entry->deferred)
+				{
+					if (! g_list_find_custom(deferred_plugins_list, fname, (GCompareFunc) strcmp))
+						deferred_plugins_list = g_list_append(deferred_plugins_list, g_strdup(fname));
+					continue;
+				}
+
 				if (check_plugin_path(fname))
 					proxy = is_plugin(fname);
 				if (proxy == NULL || plugin_new(proxy->plugin, fname, TRUE, FALSE) == NULL)
@@ -1086,6 +1485,14 @@ load_active_plugins(void)
 			}
 		}
 	} while (proxies != active_proxies.length);
+
+	geany_debug("Activated %u plugin(s) in %.1f ms, %u deferred",
+		g_list_length(active_plugin_list), (g_get_monotonic_time() - start) / 1000.0,
+		g_list_length(deferred_plugins_list));
+
+	if (deferred_plugins_list != NULL)
+		deferred_plugins_source = g_idle_add_full(G_PRIORITY_LOW, activate_deferred_plugin, NULL, NULL);
+	plugin_cache_write();
 }
 
 
@@ -1241,7 +1648,8 @@ static void update_active_plugins_pref(void)
 	if (!want_plugins)
 		return;
 
-	count = g_list_length(active_plugin_list) + g_list_length(failed_plugins_list);
+	count = g_list_length(active_plugin_list) + g_list_length(failed_plugins_list) +
+		g_list_length(deferred_plugins_list);
 
 	g_strfreev(active_plugins_pref);
 
@@ -1267,6 +1675,14 @@ static void update_active_plugins_pref(void)
 		active_plugins_pref[i] = g_strdup(fname);
 		i++;
 	}
+	/* plugins not activated yet */
+	for (list = g_list_first(deferred_plugins_list); list != NULL; list = list->next)
+	{
+		const gchar *fname = list->data;
+
+		active_plugins_pref[i] = g_strdup(fname);
+		i++;
+	}
 	active_plugins_pref[i] = NULL;
 }
 
@@ -1292,6 +1708,11 @@ void plugins_init(void)
 	g_signal_connect(geany_object, "save-settings", G_CALLBACK(update_active_plugins_pref), NULL);
 	stash_group_add_string_vector(group, &active_plugins_pref, "active_plugins", NULL);
 
+	group = stash_group_new(PACKAGE);
+	configuration_add_various_pref_group(group, "plugins");
+
+	stash_group_add_integer(group, &signal_handler_budget, "signal_handler_budget", 50);
+
 	g_queue_push_head(&active_proxies, &builtin_so_proxy);
 }
 
@@ -1310,6 +1731,10 @@ static void plugin_free_leaf(gpointer data, gpointer user_data G_GNUC_UNUSED)
 /* called even if plugin support is disabled */
 void plugins_finalize(void)
 {
+	if (deferred_plugins_source != 0)
+		g_source_remove(deferred_plugins_source);
+	g_list_free_full(deferred_plugins_list, g_free);
+
 	if (failed_plugins_list != NULL)
 	{
 		g_list_free_full(failed_plugins_list, g_free);
@@ -1320,6 +1745,12 @@ void plugins_finalize(void)
 		g_list_foreach(active_plugin_list, plugin_free_leaf, NULL);
 
 	g_strfreev(active_plugins_pref);
+
+	if (plugin_cache != NULL)
+	{
+		plugin_cache_write();
+		g_hash_table_destroy(plugin_cache);
+	}
 }
 
 
@@ -1631,6 +2062,15 @@ static void pm_treeview_text_cell_data_func(GtkTreeViewColumn *column, GtkCellRe
 	{
 		gchar *markup = g_markup_printf_escaped("<b>%s</b>\n%s", p->info.name, p->info.description);
 
+		if (is_active_plugin(p))
+		{
+			gchar *time = g_markup_printf_escaped(
+				_("Startup: %.1f ms, signal handlers: %.1f ms in %u calls"),
+				p->load_time / 1000.0, p->signal_time / 1000.0, p->signal_calls);
+
+			SETPTR(markup, g_strconcat(markup, "\n<small><i>", time, "</i></small>", NULL));
+			g_free(time);
+		}
 		g_object_set(cell, "markup", markup, NULL);
 		g_free(markup);
 	}
@@ -1825,6 +2265,7 @@ static void pm_dialog_response(GtkDialog *dialog, gint response, gpointer user_d
 			gtk_widget_destroy(GTK_WIDGET(dialog));
 			pm_widgets.dialog = NULL;
 
+			plugin_cache_write();
 			configuration_save();
 			break;
 		case PM_BUTTON_CONFIGURE:
@@ -1847,6 +2288,14 @@ static void pm_show_dialog(GtkMenuItem *menuitem, gpointer user_data)
 		return;
 	}
 
+	/* the dialog should show the deferred plugins as active */
+	if (deferred_plugins_source != 0)
+	{
+		g_source_remove(deferred_plugins_source);
+		while (deferred_plugins_list != NULL)
+			activate_deferred_plugin(NULL);
+	}
+
 	/* before showing the dialog, we need to create the list of available plugins */
 	load_all_plugins();
 
@@ -125,6 +125,32 @@ void plugin_module_make_resident(GeanyPlugin *plugin)
 }
 
 
+/** Lets Geany activate the plugin after the main window is shown at startup.
+ *
+ * Activating plugins one after another before the main window is shown delays startup.
+ * Plugins that only add menu items, keybindings or similar don't need to be active
+ * before that and can call this to be activated from an idle callback instead.
+ * Such plugins don't see the signals emitted while Geany starts up, e.g.
+ * @c "document-open" for the session files, so they should handle the already open
+ * documents in their init function if they need to.
+ *
+ * The setting is remembered in Geany's plugin cache and takes effect from the next
+ * start, so it can be called from @c geany_load_module() or from the init function.
+ * It is ignored for proxy plugins.
+ *
+ * @param plugin Must be @ref geany_plugin.
+ * @param deferred @c TRUE to allow deferred activation.
+ *
+ * @since 2.2
+ */
+GEANY_API_SYMBOL
+void plugin_set_deferred_activation(GeanyPlugin *plugin, gboolean deferred)
+{
+	g_return_if_fail(plugin);
+	plugin->priv->deferred = deferred;
+}
+
+
 /** @girskip
  * Connects a signal which will be disconnected on unloading the plugin, to prevent a possible segfault.
  * @param plugin Must be @ref geany_plugin.
@@ -168,9 +194,9 @@ void plugin_signal_connect(GeanyPlugin *plugin,
 	if (!object)
 		object = geany_object;
 
-	id = after ?
-		g_signal_connect_after(object, signal_name, callback, user_data) :
-		g_signal_connect(object, signal_name, callback, user_data);
+	/* the closure measures the time spent in the handler for the Plugin Manager */
+	id = g_signal_connect_closure(object, signal_name,
+		plugin_signal_closure_new(plugin->priv, signal_name, callback, user_data), after);
 
 	if (!plugin->priv->signal_ids)
 		plugin->priv->signal_ids = g_array_new(FALSE, FALSE, sizeof(SignalConnection));
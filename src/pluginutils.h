@@ -40,6 +40,8 @@ void plugin_add_toolbar_item(struct GeanyPlugin *plugin, GtkToolItem *item);
 
 void plugin_module_make_resident(struct GeanyPlugin *plugin);
 
+void plugin_set_deferred_activation(struct GeanyPlugin *plugin, gboolean deferred);
+
 void plugin_signal_connect(struct GeanyPlugin *plugin,
 		GObject *object, const gchar *signal_name, gboolean after,
 		GCallback callback, gpointer user_data);
@@ -34,7 +34,6 @@
 #include "dialogs.h"
 #include "document.h"
 #include "geany.h"
-#include "highlighting.h"
 #include "msgwindow.h"
 #include "sciwrappers.h"
 #include "spawn.h"
@@ -349,12 +348,9 @@ static void begin_print(GtkPrintOperation *operation, GtkPrintContext *context,
 	/* init dinfo fields */
 
 	/* setup printing scintilla object */
-	dinfo->sci = editor_create_widget(dinfo->doc->editor);
+	dinfo->sci = editor_create_view(dinfo->doc->editor);
 	/* since we won't add the widget to any container, assume it's ownership */
 	g_object_ref_sink(dinfo->sci);
-	SSM(dinfo->sci, SCI_SETDOCPOINTER, 0,
-			SSM(dinfo->doc->editor->sci, SCI_GETDOCPOINTER, 0, 0));
-	highlighting_set_styles(dinfo->sci, dinfo->doc->file_type);
 	sci_set_line_numbers(dinfo->sci, printing_prefs.print_line_numbers);
 	SSM(dinfo->sci, SCI_SETVIEWWS, SCWS_INVISIBLE, 0);
 	SSM(dinfo->sci, SCI_SETVIEWEOL, FALSE, 0);
@@ -392,6 +392,97 @@ gboolean sci_is_modified(ScintillaObject *sci)
 }
 
 
+/* The following give access to Scintilla's undo history, e.g. to move parts of it
+ * out of memory. See the SCI_GETUNDOACTIONS documentation for how it is rebuilt. */
+gint sci_get_undo_actions(ScintillaObject *sci)
+{
+	return (gint) SSM(sci, SCI_GETUNDOACTIONS, 0, 0);
+}
+
+
+gint sci_get_undo_current(ScintillaObject *sci)
+{
+	return (gint) SSM(sci, SCI_GETUNDOCURRENT, 0, 0);
+}
+
+
+/* Must be called last when rebuilding the history as it validates it, discarding the
+ * whole history if it does not fit the document. Returns FALSE in that case. */
+gboolean sci_set_undo_current(ScintillaObject *sci, gint action)
+{
+	gint n_actions = sci_get_undo_actions(sci);
+
+	/* not SSM() which resets the status in debug builds */
+	scintilla_send_message(sci, SCI_SETSTATUS, SC_STATUS_OK, 0);
+	SSM(sci, SCI_SETUNDOCURRENT, (uptr_t) action, 0);
+	return scintilla_send_message(sci, SCI_GETSTATUS, 0, 0) == SC_STATUS_OK &&
+		sci_get_undo_actions(sci) == n_actions;
+}
+
+
+gint sci_get_undo_save_point(ScintillaObject *sci)
+{
+	return (gint) SSM(sci, SCI_GETUNDOSAVEPOINT, 0, 0);
+}
+
+
+void sci_set_undo_save_point(ScintillaObject *sci, gint action)
+{
+	SSM(sci, SCI_SETUNDOSAVEPOINT, (uptr_t) action, 0);
+}
+
+
+gint sci_get_undo_detach(ScintillaObject *sci)
+{
+	return (gint) SSM(sci, SCI_GETUNDODETACH, 0, 0);
+}
+
+
+void sci_set_undo_detach(ScintillaObject *sci, gint action)
+{
+	SSM(sci, SCI_SETUNDODETACH, (uptr_t) action, 0);
+}
+
+
+/* Whether a user action or an input method composition is in progress, in which case
+ * the history must not be rebuilt. */
+gboolean sci_is_undo_sequence_open(ScintillaObject *sci)
+{
+	return SSM(sci, SCI_GETUNDOSEQUENCE, 0, 0) > 0 || SSM(sci, SCI_GETUNDOTENTATIVE, 0, 0) >= 0;
+}
+
+
+gint sci_get_undo_action_type(ScintillaObject *sci, gint action)
+{
+	return (gint) SSM(sci, SCI_GETUNDOACTIONTYPE, (uptr_t) action, 0);
+}
+
+
+gint sci_get_undo_action_position(ScintillaObject *sci, gint action)
+{
+	return (gint) SSM(sci, SCI_GETUNDOACTIONPOSITION, (uptr_t) action, 0);
+}
+
+
+/* Copies the text of an action into text, which may be NULL to only get its length.
+ * Reading the texts in order from action 0 is fastest. */
+gsize sci_get_undo_action_text(ScintillaObject *sci, gint action, gchar *text)
+{
+	return (gsize) SSM(sci, SCI_GETUNDOACTIONTEXT, (uptr_t) action, (sptr_t) text);
+}
+
+
+/* Appends an action to the end of the history, type is as returned by
+ * sci_get_undo_action_type(). */
+void sci_push_undo_action(ScintillaObject *sci, gint type, gint position,
+		const gchar *text, gsize length)
+{
+	SSM(sci, SCI_PUSHUNDOACTIONTYPE, (uptr_t) type, position);
+	if (length > 0)
+		SSM(sci, SCI_CHANGELASTUNDOACTIONTEXT, length, (sptr_t) text);
+}
+
+
 void sci_zoom_in(ScintillaObject *sci)
 {
 	SSM(sci, SCI_ZOOMIN, 0, 0);
@@ -1131,6 +1222,81 @@ void sci_clear_cmdkey(ScintillaObject *sci, gint key)
 }
 
 
+/** Gets the styling between @a start and @a end as runs of consecutive bytes using the
+ * same style, which is much faster than calling sci_get_style_at() for each position.
+ * @param sci Scintilla widget.
+ * @param start Start position.
+ * @param end End position, or @c -1 for the end of the document.
+ * @return @transfer{full} A new array of @c SciStyleRun, in document order. Free it with
+ * @c g_array_unref().
+ *
+ * @see sci_get_range_pointer().
+ *
+ * @since 2.2
+ */
+GEANY_API_SYMBOL
+GArray *sci_get_style_runs(ScintillaObject *sci, gint start, gint end)
+{
+	/* read the styles in blocks to bound the temporary memory */
+	const gint block_size = 65536;
+	GArray *runs = g_array_new(FALSE, FALSE, sizeof(SciStyleRun));
+	const gint length = sci_get_length(sci);
+	SciStyleRun run = { start, 0, -1 };
+	struct Sci_TextRangeFull tr;
+	gchar *buffer;
+
+	if (end < 0 || end > length)
+		end = length;
+	buffer = g_malloc(2 * MIN(MAX(end - start, 0), block_size) + 2);
+	tr.lpstrText = buffer;
+
+	for (tr.chrg.cpMin = start; tr.chrg.cpMin < end; tr.chrg.cpMin = tr.chrg.cpMax)
+	{
+		gint i, n;
+
+		tr.chrg.cpMax = MIN(tr.chrg.cpMin + block_size, end);
+		/* fills pairs of (character, style) */
+		n = (gint) SSM(sci, SCI_GETSTYLEDTEXTFULL, 0, (sptr_t) &tr) / 2;
+		for (i = 0; i < n; i++)
+		{
+			gint style = (guchar) buffer[2 * i + 1];
+
+			if (style != run.style)
+			{
+				if (run.length > 0)
+					g_array_append_val(runs, run);
+				run.start = (gint) tr.chrg.cpMin + i;
+				run.length = 0;
+				run.style = style;
+			}
+			run.length++;
+		}
+	}
+	if (run.length > 0)
+		g_array_append_val(runs, run);
+
+	g_free(buffer);
+	return runs;
+}
+
+
+/** Gets a pointer to the text between @a start and @a start + @a length, without copying it.
+ * The pointer is only valid until the document is modified or another range of it
+ * is requested, so do not keep it.
+ * @param sci Scintilla widget.
+ * @param start Start position.
+ * @param length Length of the range.
+ * @return @transfer{none} The text, not nul-terminated.
+ *
+ * @since 2.2
+ */
+GEANY_API_SYMBOL
+const gchar *sci_get_range_pointer(ScintillaObject *sci, gint start, gint length)
+{
+	return (const gchar *) SSM(sci, SCI_GETRANGEPOINTER, (uptr_t) start, length);
+}
+
+
 /** Gets text between @a start and @a end.
  * @deprecated sci_get_text_range is deprecated and should not be used in newly-written code.
  * Use sci_get_contents_range() instead.
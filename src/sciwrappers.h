@@ -29,6 +29,16 @@
 
 G_BEGIN_DECLS
 
+/** A range of text using the same style, see sci_get_style_runs().
+ * @since 2.2 */
+typedef struct SciStyleRun
+{
+	gint start;		/**< Position of the first byte of the run. */
+	gint length;	/**< Length of the run in bytes. */
+	gint style;		/**< Style ID of the run. */
+}
+SciStyleRun;
+
 #ifdef GEANY_PRIVATE
 # ifndef NDEBUG
 #  define SSM(s, m, w, l) sci_send_message_internal(__FILE__, __LINE__, s, m, w, l)
@@ -84,6 +94,8 @@ void				sci_set_font				(ScintillaObject *sci, gint style, const gchar *font, gi
 void				sci_goto_line				(ScintillaObject *sci, gint line, gboolean unfold);
 gint				sci_get_style_at			(ScintillaObject *sci, gint position);
 gchar*				sci_get_contents_range		(ScintillaObject *sci, gint start, gint end);
+GArray*				sci_get_style_runs			(ScintillaObject *sci, gint start, gint end);
+const gchar*		sci_get_range_pointer		(ScintillaObject *sci, gint start, gint length);
 void				sci_insert_text				(ScintillaObject *sci, gint pos, const gchar *text);
 
 void				sci_set_target_start		(ScintillaObject *sci, gint start);
@@ -123,6 +135,19 @@ void 				sci_undo					(ScintillaObject *sci);
 void 				sci_redo					(ScintillaObject *sci);
 void 				sci_empty_undo_buffer		(ScintillaObject *sci);
 gboolean			sci_is_modified				(ScintillaObject *sci);
+gint				sci_get_undo_actions		(ScintillaObject *sci);
+gint				sci_get_undo_current		(ScintillaObject *sci);
+gboolean			sci_set_undo_current		(ScintillaObject *sci, gint action);
+gint				sci_get_undo_save_point		(ScintillaObject *sci);
+void				sci_set_undo_save_point		(ScintillaObject *sci, gint action);
+gint				sci_get_undo_detach			(ScintillaObject *sci);
+void				sci_set_undo_detach			(ScintillaObject *sci, gint action);
+gboolean			sci_is_undo_sequence_open	(ScintillaObject *sci);
+gint				sci_get_undo_action_type	(ScintillaObject *sci, gint action);
+gint				sci_get_undo_action_position(ScintillaObject *sci, gint action);
+gsize				sci_get_undo_action_text	(ScintillaObject *sci, gint action, gchar *text);
+void				sci_push_undo_action		(ScintillaObject *sci, gint type, gint position,
+												 const gchar *text, gsize length);
 
 void				sci_set_visible_eols		(ScintillaObject *sci, gboolean set);
 void				sci_set_lines_wrapped		(ScintillaObject *sci, gboolean set);
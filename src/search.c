@@ -54,6 +54,14 @@
 
 #define MIN_DLG_BUTTON_SIZE 130
 
+/* Mark All searches this many bytes (rounded up to whole lines) between checking
+ * whether its time slice is over */
+#define MARK_ALL_CHUNK_SIZE 65536
+/* Time Mark All may spend per main loop iteration, in microseconds */
+#define MARK_ALL_TIME_SLICE 10000
+/* Find Usage results added to the message window per main loop iteration */
+#define USAGE_ROWS_PER_BATCH 500
+
 enum
 {
 	GEANY_RESPONSE_FIND = 1,
@@ -110,6 +118,7 @@ static struct
 }
 settings;
 
+static GThreadPool *usage_pool = NULL;	/* for session-wide Find Usage */
 static StashGroup *fif_prefs = NULL;
 static StashGroup *find_prefs = NULL;
 static StashGroup *replace_prefs = NULL;
@@ -158,6 +167,11 @@ static gchar **search_get_argv(const gchar **argv_prefix, const gchar *dir);
 
 static GRegex *compile_regex(const gchar *str, GeanyFindFlags sflags);
 
+static gint find_regex(ScintillaObject *sci, guint pos, GRegex *regex, gboolean multiline,
+	gint end, GeanyMatchInfo *match);
+
+static gint geany_find_flags_to_sci_flags(GeanyFindFlags flags);
+
 
 static void
 on_find_replace_checkbutton_toggled(GtkToggleButton *togglebutton, gpointer user_data);
@@ -295,6 +309,10 @@ void search_finalize(void)
 	FREE_WIDGET(fif_dlg.dialog);
 	g_free(search_data.text);
 	g_free(search_data.original_text);
+
+	search_find_usage_cancel();
+	if (usage_pool)
+		g_thread_pool_free(usage_pool, FALSE, TRUE);
 }
 
 
@@ -1309,40 +1327,285 @@ static GSList *find_range(ScintillaObject *sci, GeanyFindFlags flags, struct Sci
 }
 
 
-/* Clears markers if text is null/empty.
+typedef struct
+{
+	gint start, end;
+}
+MarkRange;
+
+/* State of a Mark All still running in the background, see search_mark_all() */
+static struct
+{
+	guint doc_id;
+	gchar *text;
+	gchar *original_text;
+	GeanyFindFlags flags;
+	GRegex *regex;
+	GArray *marked;		/* sorted, disjoint MarkRanges already searched */
+	gint pos;			/* where the sweep through the document continues */
+	gint count;
+	guint source_id;
+}
+mark_all_job;
+
+
+/* Marks the matches starting in start..end.
  * @return Number of matches marked. */
-gint search_mark_all(GeanyDocument *doc, const gchar *search_text, GeanyFindFlags flags)
+static gint mark_range(ScintillaObject *sci, const gchar *text, GeanyFindFlags flags, GRegex *regex,
+		gint start, gint end)
 {
-	gint count = 0;
+	GeanyMatchInfo *match = regex ? match_info_new(flags, 0, 0) : NULL;
 	struct Sci_TextToFind ttf;
-	GSList *match, *matches;
+	gint count = 0;
+
+	ttf.chrg.cpMin = start;
+	ttf.chrg.cpMax = end;
+	ttf.lpstrText = (gchar *) text;
+
+	while (ttf.chrg.cpMin <= end)
+	{
+		if (regex)
+		{
+			if (find_regex(sci, ttf.chrg.cpMin, regex, flags & GEANY_FIND_MULTILINE, end, match) < 0)
+				break;
+			ttf.chrgText.cpMin = match->start;
+			ttf.chrgText.cpMax = match->end;
+		}
+		else if (sci_find_text(sci, geany_find_flags_to_sci_flags(flags), &ttf) < 0)
+			break;
+
+		/* found text is (partially) out of range */
+		if (ttf.chrgText.cpMin >= end || ttf.chrgText.cpMax > end)
+			break;
+
+		if (ttf.chrgText.cpMax != ttf.chrgText.cpMin)
+			sci_indicator_fill(sci, ttf.chrgText.cpMin, ttf.chrgText.cpMax - ttf.chrgText.cpMin);
+		count++;
+
+		/* avoid rematching with empty matches, see find_range() */
+		ttf.chrg.cpMin = ttf.chrgText.cpMax;
+		if (ttf.chrgText.cpMax == ttf.chrgText.cpMin)
+			ttf.chrg.cpMin ++;
+	}
+
+	if (match)
+		geany_match_info_free(match);
+	return count;
+}
+
+
+/* Marks the parts of start..end that haven't been searched yet */
+static void mark_all_range(ScintillaObject *sci, gint start, gint end)
+{
+	GArray *marked = mark_all_job.marked;
+	MarkRange range = { start, end };
+	guint i;
+
+	for (i = 0; i < marked->len && start < end; i++)
+	{
+		MarkRange *r = &g_array_index(marked, MarkRange, i);
+
+		if (r->end <= start)
+			continue;
+		if (r->start >= end)
+			break;
+		if (r->start > start)
+			mark_all_job.count += mark_range(sci, mark_all_job.text, mark_all_job.flags,
+				mark_all_job.regex, start, r->start);
+		start = MAX(start, r->end);
+	}
+	if (start < end)
+		mark_all_job.count += mark_range(sci, mark_all_job.text, mark_all_job.flags,
+			mark_all_job.regex, start, end);
+
+	/* merge the range into the overlapping and adjacent ones */
+	for (i = 0; i < marked->len; )
+	{
+		MarkRange *r = &g_array_index(marked, MarkRange, i);
+
+		if (r->end < range.start)
+			i++;
+		else if (r->start > range.end)
+			break;
+		else
+		{
+			range.start = MIN(range.start, r->start);
+			range.end = MAX(range.end, r->end);
+			g_array_remove_index(marked, i);
+		}
+	}
+	g_array_insert_val(marked, i, range);
+}
+
+
+/* Marks the lines on screen, then sweeps through the rest of the document until
+ * the time slice is over.
+ * @return Whether the whole document has been searched. */
+static gboolean mark_all_continue(GeanyDocument *doc)
+{
+	ScintillaObject *sci = doc->editor->sci;
+	gint length = sci_get_length(sci);
+	gint line_count = sci_get_line_count(sci);
+	gint first = (gint) SSM(sci, SCI_GETFIRSTVISIBLELINE, 0, 0);
+	gint last = first + (gint) SSM(sci, SCI_LINESONSCREEN, 0, 0);
+	gint64 deadline = g_get_monotonic_time() + MARK_ALL_TIME_SLICE;
+
+	sci_indicator_set(sci, GEANY_INDICATOR_SEARCH);
+
+	/* visible lines first, so that what the user looks at is marked immediately */
+	first = (gint) SSM(sci, SCI_DOCLINEFROMVISIBLE, first, 0);
+	last = (gint) SSM(sci, SCI_DOCLINEFROMVISIBLE, last, 0) + 1;
+	mark_all_range(sci, sci_get_position_from_line(sci, first),
+		(last < line_count) ? sci_get_position_from_line(sci, last) : length);
+
+	while (mark_all_job.pos < length && g_get_monotonic_time() < deadline)
+	{
+		gint line = sci_get_line_from_position(sci, MIN(mark_all_job.pos + MARK_ALL_CHUNK_SIZE, length));
+		gint end = (line + 1 < line_count) ? sci_get_position_from_line(sci, line + 1) : length;
+
+		mark_all_range(sci, mark_all_job.pos, end);
+		mark_all_job.pos = end;
+	}
+	return mark_all_job.pos >= length;
+}
+
+
+static void report_mark_all_count(gint count, const gchar *original_text)
+{
+	if (count == 0)
+		ui_set_statusbar(FALSE, _("No matches found for \"%s\"."), original_text);
+	else
+		ui_set_statusbar(FALSE,
+			ngettext("Found %d match for \"%s\".",
+					 "Found %d matches for \"%s\".", count),
+			count, original_text);
+}
+
+
+static void mark_all_job_free(void)
+{
+	if (mark_all_job.source_id)
+		g_source_remove(mark_all_job.source_id);
+	if (mark_all_job.regex)
+		g_regex_unref(mark_all_job.regex);
+	if (mark_all_job.marked)
+		g_array_free(mark_all_job.marked, TRUE);
+	g_free(mark_all_job.text);
+	g_free(mark_all_job.original_text);
+	memset(&mark_all_job, 0, sizeof mark_all_job);
+}
+
+
+static gboolean mark_all_idle(G_GNUC_UNUSED gpointer data)
+{
+	GeanyDocument *doc = document_find_by_id(mark_all_job.doc_id);
+
+	if (doc == NULL)
+	{
+		mark_all_job.source_id = 0;
+		mark_all_job_free();
+		return G_SOURCE_REMOVE;
+	}
+
+	if (! mark_all_continue(doc))
+	{
+		ui_set_statusbar(FALSE,
+			ngettext("Marking matches for \"%s\"... %d match found so far.",
+					 "Marking matches for \"%s\"... %d matches found so far.", mark_all_job.count),
+			mark_all_job.original_text, mark_all_job.count);
+		return G_SOURCE_CONTINUE;
+	}
+
+	report_mark_all_count(mark_all_job.count, mark_all_job.original_text);
+	mark_all_job.source_id = 0;
+	mark_all_job_free();
+	return G_SOURCE_REMOVE;
+}
+
+
+/* Stops a Mark All running in the background for doc, e.g. because the text changed
+ * and the positions it is at are no longer valid. The matches marked so far stay,
+ * the statusbar tells that they are incomplete. */
+void search_mark_all_cancel(GeanyDocument *doc)
+{
+	if (mark_all_job.source_id && doc->id == mark_all_job.doc_id)
+	{
+		ui_set_statusbar(FALSE,
+			ngettext("Marking matches for \"%s\" stopped because the document changed, "
+					 "%d match marked.",
+					 "Marking matches for \"%s\" stopped because the document changed, "
+					 "%d matches marked.", mark_all_job.count),
+			mark_all_job.original_text, mark_all_job.count);
+		mark_all_job_free();
+	}
+}
+
+
+static gint mark_all(GeanyDocument *doc, const gchar *search_text, const gchar *original_text,
+		GeanyFindFlags flags)
+{
+	ScintillaObject *sci;
 
 	g_return_val_if_fail(DOC_VALID(doc), 0);
 
+	/* any running Mark All is for an older search */
+	mark_all_job_free();
+
 	/* clear previous search indicators */
 	editor_indicator_clear(doc->editor, GEANY_INDICATOR_SEARCH);
 
 	if (G_UNLIKELY(EMPTY(search_text)))
 		return 0;
 
-	ttf.chrg.cpMin = 0;
-	ttf.chrg.cpMax = sci_get_length(doc->editor->sci);
-	ttf.lpstrText = (gchar *)search_text;
+	sci = doc->editor->sci;
+	mark_all_job.doc_id = doc->id;
+	mark_all_job.flags = flags;
+	mark_all_job.marked = g_array_new(FALSE, FALSE, sizeof(MarkRange));
+	if (flags & GEANY_FIND_REGEXP)
+	{
+		mark_all_job.regex = compile_regex(search_text, flags);
+		if (! mark_all_job.regex)
+		{
+			mark_all_job_free();
+			return 0;
+		}
+	}
 
-	matches = find_range(doc->editor->sci, flags, &ttf);
-	foreach_slist (match, matches)
+	/* matches spanning lines could span two chunks, so search them all at once */
+	if ((flags & GEANY_FIND_MULTILINE) || strpbrk(search_text, "\r\n"))
 	{
-		GeanyMatchInfo *info = match->data;
+		gint count;
 
-		if (info->end != info->start)
-			editor_indicator_set_on_range(doc->editor, GEANY_INDICATOR_SEARCH, info->start, info->end);
-		count++;
+		sci_indicator_set(sci, GEANY_INDICATOR_SEARCH);
+		count = mark_range(sci, search_text, flags, mark_all_job.regex, 0, sci_get_length(sci));
+		mark_all_job_free();
+		return count;
+	}
 
-		geany_match_info_free(info);
+	mark_all_job.text = g_strdup(search_text);
+	if (! mark_all_continue(doc))
+	{
+		mark_all_job.original_text = g_strdup(original_text);
+		mark_all_job.source_id = g_idle_add(mark_all_idle, NULL);
+		return -1;
 	}
-	g_slist_free(matches);
+	else
+	{
+		gint count = mark_all_job.count;
 
-	return count;
+		mark_all_job_free();
+		return count;
+	}
+}
+
+
+/* Clears markers if text is null/empty.
+ * Large documents are marked incrementally: the visible lines first, then the rest
+ * in the background, reporting the progress and the final count in the statusbar.
+ * @return Number of matches marked, or -1 if marking continues in the background. */
+gint search_mark_all(GeanyDocument *doc, const gchar *search_text, GeanyFindFlags flags)
+{
+	return mark_all(doc, search_text, search_text, flags);
 }
 
 
@@ -1447,15 +1710,11 @@ on_find_dialog_response(GtkDialog *dialog, gint response, gpointer user_data)
 
 			case GEANY_RESPONSE_MARK:
 			{
-				gint count = search_mark_all(doc, search_data.text, search_data.flags);
-
-				if (count == 0)
-					ui_set_statusbar(FALSE, _("No matches found for \"%s\"."), search_data.original_text);
-				else
-					ui_set_statusbar(FALSE,
-						ngettext("Found %d match for \"%s\".",
-								 "Found %d matches for \"%s\".", count),
-						count, search_data.original_text);
+				gint count = mark_all(doc, search_data.text, search_data.original_text, search_data.flags);
+
+				/* otherwise reported when done */
+				if (count >= 0)
+					report_mark_all_count(count, search_data.original_text);
 			}
 			break;
 		}
@@ -2001,6 +2260,30 @@ static void search_finished(GPid child_pid, gint status, gpointer user_data)
 }
 
 
+/* The last regex compiled. A search compiles the same pattern again for every match
+ * (find_range(), search_find_text()), so it's kept around and shared. */
+static struct
+{
+	gchar *pattern;
+	gint rflags;
+	GRegex *regex;
+	GRegex *buffer_regex;	/* see get_buffer_regex() */
+	gboolean buffer_regex_checked;
+}
+regex_cache;
+
+
+static void regex_cache_clear(void)
+{
+	if (regex_cache.regex)
+		g_regex_unref(regex_cache.regex);
+	if (regex_cache.buffer_regex)
+		g_regex_unref(regex_cache.buffer_regex);
+	g_free(regex_cache.pattern);
+	memset(&regex_cache, 0, sizeof regex_cache);
+}
+
+
 static GRegex *compile_regex(const gchar *str, GeanyFindFlags sflags)
 {
 	GRegex *regex;
@@ -2016,26 +2299,117 @@ static GRegex *compile_regex(const gchar *str, GeanyFindFlags sflags)
 		geany_debug("%s: Unsupported regex flags found!", G_STRFUNC);
 	}
 
+	if (regex_cache.regex && regex_cache.rflags == rflags && strcmp(regex_cache.pattern, str) == 0)
+		return g_regex_ref(regex_cache.regex);
+
 	regex = g_regex_new(str, rflags, 0, &error);
 	if (!regex)
 	{
 		ui_set_statusbar(FALSE, _("Bad regex: %s"), error->message);
 		g_error_free(error);
+		return NULL;
 	}
+
+	regex_cache_clear();
+	regex_cache.pattern = g_strdup(str);
+	regex_cache.rflags = rflags;
+	regex_cache.regex = g_regex_ref(regex);
 	return regex;
 }
 
 
-/* groups that don't exist are handled OK as len = end - start = (-1) - (-1) = 0 */
-static gchar *get_regex_match_string(const gchar *text, const GeanyMatchInfo *match, guint nth)
+/* Whether matching pattern against many lines at once with ^ and $ matching at line
+ * boundaries finds at least every position where it matches a line on its own.
+ * Assertions about what is beyond the line (negative lookaround, \A, \z, ...) and
+ * inline options (which could turn off multiline mode) break this. So do atomic
+ * groups, possessive quantifiers and backtracking verbs: they can consume a line end
+ * and then not give it back for a following $ to match. */
+gboolean search_regex_allows_buffer_search(const gchar *pattern)
 {
-	const gint start = match->matches[nth].start;
-	const gint end = match->matches[nth].end;
-	return g_strndup(&text[start], end - start);
+	static const gchar *const unsafe[] = { "(?!", "(?<!", "\\A", "\\z", "\\Z", "\\G", "(*" };
+	const gchar *ptr;
+
+	for (guint i = 0; i < G_N_ELEMENTS(unsafe); i++)
+	{
+		if (strstr(pattern, unsafe[i]))
+			return FALSE;
+	}
+	for (ptr = strstr(pattern, "(?"); ptr; ptr = strstr(ptr + 2, "(?"))
+	{
+		/* groups and lookarounds are fine, option settings and atomic groups are not */
+		if (ptr[2] != ':' && ptr[2] != '=' && ptr[2] != '<' && ptr[2] != '|')
+			return FALSE;
+	}
+	/* a quantifier followed by + is possessive. This also rejects some patterns that
+	 * are fine, like \*+ or [?+], which only costs the faster search. */
+	for (ptr = strchr(pattern, '+'); ptr; ptr = strchr(ptr + 1, '+'))
+	{
+		if (ptr > pattern && strchr("*+?}", ptr[-1]))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+
+/* For single-line mode: regex compiled to match across line ends, so that the lines
+ * between pos and the next candidate line can be skipped in one match call instead
+ * of being matched one by one. PCRE's start-of-match optimisations (first code unit,
+ * required literal) then scan the buffer directly, and it's JIT-compiled where GLib
+ * supports it. A candidate must still be confirmed by matching its line on its own.
+ * Returns NULL if regex isn't suitable. */
+static GRegex *get_buffer_regex(GRegex *regex)
+{
+	if (regex != regex_cache.regex)
+		return NULL;
+
+	if (! regex_cache.buffer_regex_checked)
+	{
+		regex_cache.buffer_regex_checked = TRUE;
+		if (search_regex_allows_buffer_search(regex_cache.pattern))
+		{
+			regex_cache.buffer_regex = g_regex_new(regex_cache.pattern,
+				regex_cache.rflags | G_REGEX_MULTILINE | G_REGEX_NEWLINE_ANYCRLF | G_REGEX_OPTIMIZE,
+				0, NULL);
+		}
+	}
+	return regex_cache.buffer_regex;
+}
+
+
+/* Finds the first line from pos up to the line containing end - 1 on which buffer_regex
+ * matches, see get_buffer_regex(). The match can continue on the following lines, up
+ * to match_end.
+ * @return The line, or -1 if there is none. */
+static gint find_candidate_line(ScintillaObject *sci, GRegex *buffer_regex, guint pos, gint end,
+	gint *match_end)
+{
+	gint line = sci_get_line_from_position(sci, pos);
+	gint start = sci_get_position_from_line(sci, line);
+	gint last_line = sci_get_line_from_position(sci, MAX(end - 1, (gint) pos));
+	gint stop = sci_get_line_end_position(sci, last_line);
+	const gchar *text;
+	GMatchInfo *minfo;
+	gint ret = -1;
+
+	/* Warning: any SCI calls will invalidate 'text' */
+	text = (void*)SSM(sci, SCI_GETRANGEPOINTER, start, stop - start);
+	if (g_regex_match_full(buffer_regex, text, stop - start, pos - start, 0, &minfo, NULL))
+	{
+		gint match_start = -1;
+
+		g_match_info_fetch_pos(minfo, 0, &match_start, match_end);
+		ret = start + match_start;
+		*match_end += start;
+	}
+	g_match_info_free(minfo);
+
+	return ret < 0 ? -1 : sci_get_line_from_position(sci, ret);
 }
 
 
-static gint find_regex(ScintillaObject *sci, guint pos, GRegex *regex, gboolean multiline, GeanyMatchInfo *match)
+/* In single-line mode, lines starting at or after end are not searched */
+static gint find_regex(ScintillaObject *sci, guint pos, GRegex *regex, gboolean multiline,
+	gint end, GeanyMatchInfo *match)
 {
 	const gchar *text;
 	GMatchInfo *minfo;
@@ -2057,15 +2431,37 @@ static gint find_regex(ScintillaObject *sci, guint pos, GRegex *regex, gboolean
 	}
 	else /* single-line mode, manually match against each line */
 	{
+		GRegex *buffer_regex = get_buffer_regex(regex);
 		gint line = sci_get_line_from_position(sci, pos);
+		gint buffer_match_end = 0;
 
 		for (;;)
 		{
-			gint start = sci_get_position_from_line(sci, line);
-			gint end = sci_get_line_end_position(sci, line);
+			gint start, line_end;
+
+			/* skip to the next line that can match. If the candidate line doesn't match on
+			 * its own, the lines the buffer match spans are tried one by one rather than
+			 * searching the buffer again from each of them. */
+			if (buffer_regex && (gint) pos >= buffer_match_end)
+			{
+				gint candidate = find_candidate_line(sci, buffer_regex, pos, end, &buffer_match_end);
 
-			text = (void*)SSM(sci, SCI_GETRANGEPOINTER, start, end - start);
-			if (g_regex_match_full(regex, text, end - start, pos - start, 0, &minfo, NULL))
+				if (candidate < 0)
+				{
+					minfo = NULL;
+					break;
+				}
+				if (candidate > line)
+				{
+					line = candidate;
+					pos = sci_get_position_from_line(sci, line);
+				}
+			}
+
+			start = sci_get_position_from_line(sci, line);
+			line_end = sci_get_line_end_position(sci, line);
+			text = (void*)SSM(sci, SCI_GETRANGEPOINTER, start, line_end - start);
+			if (g_regex_match_full(regex, text, line_end - start, pos - start, 0, &minfo, NULL))
 			{
 				offset = start;
 				break;
@@ -2076,6 +2472,8 @@ static gint find_regex(ScintillaObject *sci, guint pos, GRegex *regex, gboolean
 				if (line >= sci_get_line_count(sci))
 					break;
 				pos = sci_get_position_from_line(sci, line);
+				if ((gint) pos >= end)
+					break;
 				/* don't free last info, it's freed below */
 				g_match_info_free(minfo);
 			}
@@ -2083,7 +2481,7 @@ static gint find_regex(ScintillaObject *sci, guint pos, GRegex *regex, gboolean
 	}
 
 	/* Warning: minfo will become invalid when 'text' does! */
-	if (g_match_info_matches(minfo))
+	if (minfo && g_match_info_matches(minfo))
 	{
 		guint i;
 
@@ -2153,10 +2551,10 @@ gint search_find_next(ScintillaObject *sci, const gchar *str, GeanyFindFlags fla
 	match = match_info_new(flags, 0, 0);
 
 	pos = sci_get_current_position(sci);
-	ret = find_regex(sci, pos, regex, flags & GEANY_FIND_MULTILINE, match);
+	ret = find_regex(sci, pos, regex, flags & GEANY_FIND_MULTILINE, sci_get_length(sci), match);
 	/* avoid re-matching the same position in case of empty matches */
 	if (ret == pos && match->matches[0].start == match->matches[0].end)
-		ret = find_regex(sci, pos + 1, regex, flags & GEANY_FIND_MULTILINE, match);
+		ret = find_regex(sci, pos + 1, regex, flags & GEANY_FIND_MULTILINE, sci_get_length(sci), match);
 	if (ret >= 0)
 		sci_set_selection(sci, match->start, match->end);
 
@@ -2170,46 +2568,60 @@ gint search_find_next(ScintillaObject *sci, const gchar *str, GeanyFindFlags fla
 }
 
 
-gint search_replace_match(ScintillaObject *sci, const GeanyMatchInfo *match, const gchar *replace_text)
+/* Appends the replacement for match to str, expanding back-references for regex matches */
+static void append_replacement(GString *str, const GeanyMatchInfo *match, const gchar *replace_text)
 {
-	GString *str;
-	gint ret = 0;
-	gint i = 0;
-
-	sci_set_target_start(sci, match->start);
-	sci_set_target_end(sci, match->end);
+	const gchar *ptr;
 
 	if (! (match->flags & GEANY_FIND_REGEXP))
-		return sci_replace_target(sci, replace_text, FALSE);
+	{
+		g_string_append(str, replace_text);
+		return;
+	}
 
-	str = g_string_new(replace_text);
-	while (str->str[i])
+	for (ptr = replace_text; *ptr; ptr++)
 	{
-		gchar *ptr = &str->str[i];
-		gchar *grp;
-		gchar c;
+		const gchar c = ptr[1];
+		guint nth;
 
 		if (ptr[0] != '\\')
 		{
-			i++;
+			g_string_append_c(str, ptr[0]);
 			continue;
 		}
-		c = ptr[1];
 		/* backslash or unnecessary escape */
 		if (c == '\\' || !isdigit(c))
 		{
-			g_string_erase(str, i, 1);
-			i++;
+			if (c == '\0')
+				break;
+			g_string_append_c(str, c);
+			ptr++;
 			continue;
 		}
-		/* digit escape */
-		g_string_erase(str, i, 2);
-		/* fix match offsets by subtracting index of whole match start from the string */
-		grp = get_regex_match_string(match->match_text - match->matches[0].start, match, c - '0');
-		g_string_insert(str, i, grp);
-		i += strlen(grp);
-		g_free(grp);
+		/* digit escape; groups that don't exist are handled OK as len = (-1) - (-1) = 0.
+		 * fix match offsets by subtracting index of whole match start from the string */
+		nth = (guint) (c - '0');
+		g_string_append_len(str,
+			match->match_text + match->matches[nth].start - match->matches[0].start,
+			match->matches[nth].end - match->matches[nth].start);
+		ptr++;
 	}
+}
+
+
+gint search_replace_match(ScintillaObject *sci, const GeanyMatchInfo *match, const gchar *replace_text)
+{
+	GString *str;
+	gint ret = 0;
+
+	sci_set_target_start(sci, match->start);
+	sci_set_target_end(sci, match->end);
+
+	if (! (match->flags & GEANY_FIND_REGEXP))
+		return sci_replace_target(sci, replace_text, FALSE);
+
+	str = g_string_new(NULL);
+	append_replacement(str, match, replace_text);
 	ret = sci_replace_target(sci, str->str, FALSE);
 	g_string_free(str, TRUE);
 	return ret;
@@ -2236,7 +2648,7 @@ gint search_find_text(ScintillaObject *sci, GeanyFindFlags flags, struct Sci_Tex
 
 	match = match_info_new(flags, 0, 0);
 
-	ret = find_regex(sci, ttf->chrg.cpMin, regex, flags & GEANY_FIND_MULTILINE, match);
+	ret = find_regex(sci, ttf->chrg.cpMin, regex, flags & GEANY_FIND_MULTILINE, ttf->chrg.cpMax, match);
 	if (ret >= ttf->chrg.cpMax)
 		ret = -1;
 	else if (ret >= 0)
@@ -2295,38 +2707,356 @@ static gint find_document_usage(GeanyDocument *doc, const gchar *search_text, Ge
 }
 
 
-void search_find_usage(const gchar *search_text, const gchar *original_search_text,
-		GeanyFindFlags flags, gboolean in_session)
+/* Scintilla's character classes, see Document::WordCharacterClass() */
+enum
 {
-	GeanyDocument *doc;
-	gint count = 0;
+	CHAR_CLASS_SPACE,
+	CHAR_CLASS_NEWLINE,
+	CHAR_CLASS_WORD,
+	CHAR_CLASS_PUNCTUATION
+};
 
-	doc = document_get_current();
-	g_return_if_fail(doc != NULL);
+/* A line with matches found by a UsageTask, also the line the search is in */
+typedef struct
+{
+	gint line;
+	gsize start, end;	/* offsets into the snapshot */
+}
+UsageLine;
+
+/* The search of one document in a session-wide Find Usage, run on usage_pool */
+typedef struct
+{
+	struct UsageSearch *search;
+	guint doc_id;
+	gchar *short_file_name;
+	gchar *text;		/* snapshot of the document */
+	gsize length;
+	guint8 char_classes[128];	/* the document's classes of ASCII characters */
+	GArray *lines;		/* UsageLine */
+	gint count;
+	gint done;			/* atomic, whether lines and count are final */
+}
+UsageTask;
 
-	if (G_UNLIKELY(EMPTY(search_text)))
-	{
-		utils_beep();
+/* A session-wide Find Usage, see search_find_usage() */
+typedef struct UsageSearch
+{
+	gint ref_count;		/* atomic; the main thread and every unfinished task hold one */
+	gint cancelled;		/* atomic */
+	GeanyFindFlags flags;
+	GRegex *regex;
+	GRegex *buffer_regex;	/* NULL unless searching a regex in single-line mode */
+	gchar *original_text;
+	GPtrArray *tasks;	/* UsageTask, in document order */
+	guint next_task;	/* first task whose results haven't been shown yet */
+	guint next_line;	/* first line of it not shown yet */
+	gint count;
+	guint source_id;
+}
+UsageSearch;
+
+static UsageSearch *usage_search = NULL;	/* the one running */
+
+
+static void usage_search_unref(UsageSearch *search)
+{
+	guint i;
+
+	if (! g_atomic_int_dec_and_test(&search->ref_count))
 		return;
+
+	for (i = 0; i < search->tasks->len; i++)
+	{
+		UsageTask *task = g_ptr_array_index(search->tasks, i);
+
+		g_free(task->short_file_name);
+		g_free(task->text);
+		g_array_free(task->lines, TRUE);
+		g_free(task);
 	}
-	reset_msgwin();
+	g_ptr_array_free(search->tasks, TRUE);
+	g_regex_unref(search->regex);
+	if (search->buffer_regex)
+		g_regex_unref(search->buffer_regex);
+	g_free(search->original_text);
+	g_free(search);
+}
+
+
+static guint get_char_class(const UsageTask *task, gunichar ch)
+{
+	if (ch < G_N_ELEMENTS(task->char_classes))
+		return task->char_classes[ch];
+
+	switch (g_unichar_type(ch))
+	{
+		case G_UNICODE_LINE_SEPARATOR:
+		case G_UNICODE_PARAGRAPH_SEPARATOR:
+			return CHAR_CLASS_NEWLINE;
+
+		case G_UNICODE_SPACE_SEPARATOR:
+		case G_UNICODE_CONTROL:
+		case G_UNICODE_FORMAT:
+		case G_UNICODE_SURROGATE:
+		case G_UNICODE_PRIVATE_USE:
+		case G_UNICODE_UNASSIGNED:
+			return CHAR_CLASS_SPACE;
+
+		case G_UNICODE_UPPERCASE_LETTER:
+		case G_UNICODE_LOWERCASE_LETTER:
+		case G_UNICODE_TITLECASE_LETTER:
+		case G_UNICODE_MODIFIER_LETTER:
+		case G_UNICODE_OTHER_LETTER:
+		case G_UNICODE_DECIMAL_NUMBER:
+		case G_UNICODE_LETTER_NUMBER:
+		case G_UNICODE_OTHER_NUMBER:
+		case G_UNICODE_NON_SPACING_MARK:
+		case G_UNICODE_SPACING_MARK:
+		case G_UNICODE_ENCLOSING_MARK:
+			return CHAR_CLASS_WORD;
 
-	if (! in_session)
-	{	/* use current document */
-		count = find_document_usage(doc, search_text, flags);
+		default:
+			return CHAR_CLASS_PUNCTUATION;
 	}
-	else
+}
+
+
+/* Invalid UTF-8 is taken byte by byte, like Scintilla does */
+static guint get_char_class_at(const UsageTask *task, gsize pos)
+{
+	gunichar ch = g_utf8_get_char_validated(task->text + pos, task->length - pos);
+
+	if (ch == (gunichar) -1 || ch == (gunichar) -2)
+		ch = (guchar) task->text[pos];
+	return get_char_class(task, ch);
+}
+
+
+static guint get_char_class_before(const UsageTask *task, gsize pos)
+{
+	const gchar *prev = g_utf8_find_prev_char(task->text, task->text + pos);
+
+	if (prev == NULL || g_utf8_get_char_validated(prev, pos - (prev - task->text)) >= (gunichar) -2)
+		return get_char_class(task, (guchar) task->text[pos - 1]);
+	return get_char_class_at(task, prev - task->text);
+}
+
+
+static gboolean is_word_edge(guint cc, guint cc_next)
+{
+	return cc != cc_next && (cc == CHAR_CLASS_WORD || cc == CHAR_CLASS_PUNCTUATION);
+}
+
+
+/* Document::IsWordStartAt() on the snapshot */
+static gboolean is_word_start_at(const UsageTask *task, gsize pos)
+{
+	if (pos >= task->length)
+		return FALSE;
+	return is_word_edge(get_char_class_at(task, pos),
+		pos > 0 ? get_char_class_before(task, pos) : CHAR_CLASS_SPACE);
+}
+
+
+/* Document::IsWordEndAt() on the snapshot */
+static gboolean is_word_end_at(const UsageTask *task, gsize pos)
+{
+	if (pos == 0)
+		return FALSE;
+	return is_word_edge(get_char_class_before(task, pos),
+		pos < task->length ? get_char_class_at(task, pos) : CHAR_CLASS_SPACE);
+}
+
+
+static gsize get_line_end(const UsageTask *task, gsize pos)
+{
+	while (pos < task->length && task->text[pos] != '\n' && task->text[pos] != '\r')
+		pos++;
+	return pos;
+}
+
+
+static gsize get_next_line_start(const UsageTask *task, gsize line_end)
+{
+	if (line_end + 1 < task->length && task->text[line_end] == '\r' && task->text[line_end + 1] == '\n')
+		return line_end + 2;
+	return line_end + 1;
+}
+
+
+/* Moves @a cur forward to the line containing @a pos */
+static void advance_usage_line(const UsageTask *task, UsageLine *cur, gsize pos)
+{
+	while (cur->end < task->length)
 	{
-		guint i;
-		for (i = 0; i < documents_array->len; i++)
+		gsize next = get_next_line_start(task, cur->end);
+
+		if (pos < next)
+			break;
+		cur->start = next;
+		cur->end = get_line_end(task, next);
+		cur->line++;
+	}
+}
+
+
+static gboolean match_usage_regex(GRegex *regex, const gchar *text, gsize length, gsize pos,
+		gsize *start, gsize *end)
+{
+	GMatchInfo *minfo;
+	gboolean ret;
+
+	ret = g_regex_match_full(regex, text, length, pos, 0, &minfo, NULL);
+	if (ret)
+	{
+		gint s, e;
+
+		g_match_info_fetch_pos(minfo, 0, &s, &e);
+		*start = s;
+		*end = e;
+	}
+	g_match_info_free(minfo);
+	return ret;
+}
+
+
+/* Finds the first match starting at or after pos, with the same semantics as
+ * search_find_text() on the document. @a cur is the line containing @a pos, or an
+ * earlier one, and is moved to the line of the match. */
+static gboolean find_usage_next(const UsageTask *task, gsize pos, UsageLine *cur,
+		gsize *start, gsize *end)
+{
+	const UsageSearch *search = task->search;
+	gsize buffer_match_end;
+
+	if ((~search->flags & GEANY_FIND_REGEXP) || (search->flags & GEANY_FIND_MULTILINE))
+	{
+		gboolean word = (~search->flags & GEANY_FIND_REGEXP) &&
+			(search->flags & (GEANY_FIND_WHOLEWORD | GEANY_FIND_WORDSTART));
+
+		while (match_usage_regex(search->regex, task->text, task->length, pos, start, end))
 		{
-			if (documents[i]->is_valid)
+			if (! word ||
+				((search->flags & GEANY_FIND_WHOLEWORD) && *start < *end &&
+					is_word_start_at(task, *start) && is_word_end_at(task, *end)) ||
+				((search->flags & GEANY_FIND_WORDSTART) && is_word_start_at(task, *start)))
 			{
-				count += find_document_usage(documents[i], search_text, flags);
+				advance_usage_line(task, cur, *start);
+				return TRUE;
 			}
+			/* try the next character, like Scintilla */
+			pos = *start + g_utf8_skip[(guchar) task->text[*start]];
+			if (pos > task->length)
+				break;
 		}
+		return FALSE;
+	}
+
+	/* single-line mode, match against each line */
+	buffer_match_end = 0;
+	while (pos <= task->length)
+	{
+		/* not within a CR/LF line end */
+		if (pos > 0 && pos < task->length && task->text[pos] == '\n' && task->text[pos - 1] == '\r')
+			pos++;
+
+		/* skip to the next line that can match, see get_buffer_regex() and find_regex() */
+		if (search->buffer_regex && pos >= buffer_match_end)
+		{
+			if (! match_usage_regex(search->buffer_regex, task->text, task->length, pos, start, end))
+				return FALSE;
+			buffer_match_end = *end;
+			advance_usage_line(task, cur, MAX(pos, *start));
+			pos = MAX(pos, cur->start);
+		}
+		else
+			advance_usage_line(task, cur, pos);
+
+		if (pos <= cur->end && match_usage_regex(search->regex, task->text + cur->start,
+				cur->end - cur->start, pos - cur->start, start, end))
+		{
+			*start += cur->start;
+			*end += cur->start;
+			return TRUE;
+		}
+		if (cur->end >= task->length)
+			break;
+		pos = get_next_line_start(task, cur->end);
+	}
+	return FALSE;
+}
+
+
+static void usage_task_run(gpointer data, G_GNUC_UNUSED gpointer user_data)
+{
+	UsageTask *task = data;
+	UsageSearch *search = task->search;
+	gsize pos = 0;
+	UsageLine cur = { 0, 0, get_line_end(task, 0) };
+	gint prev_line = -1;
+	gsize start, end;
+
+	while (pos <= task->length && ! g_atomic_int_get(&search->cancelled) &&
+		find_usage_next(task, pos, &cur, &start, &end))
+	{
+		if (cur.line != prev_line)
+		{
+			g_array_append_val(task->lines, cur);
+			prev_line = cur.line;
+		}
+		task->count++;
+
+		/* avoid rematching with empty matches, see find_range() */
+		pos = end;
+		if (start == end)
+			pos += (pos < task->length) ? g_utf8_skip[(guchar) task->text[pos]] : 1;
+	}
+
+	g_atomic_int_set(&task->done, TRUE);
+	usage_search_unref(search);
+}
+
+
+/* The caseless regex for plain text needs valid UTF-8, so documents that aren't are
+ * searched with Scintilla on the main thread instead, like find_document_usage() */
+static void usage_task_run_sci(UsageTask *task, ScintillaObject *sci, const gchar *search_text)
+{
+	struct Sci_TextToFind ttf;
+	gint prev_line = -1;
+	GSList *match, *matches;
+
+	ttf.chrg.cpMin = 0;
+	ttf.chrg.cpMax = (gint) task->length;
+	ttf.lpstrText = (gchar *) search_text;
+
+	matches = find_range(sci, task->search->flags, &ttf);
+	foreach_slist (match, matches)
+	{
+		GeanyMatchInfo *info = match->data;
+		gint line = sci_get_line_from_position(sci, info->start);
+
+		if (line != prev_line)
+		{
+			UsageLine usage_line;
+
+			usage_line.line = line;
+			usage_line.start = sci_get_position_from_line(sci, line);
+			usage_line.end = sci_get_line_end_position(sci, line);
+			g_array_append_val(task->lines, usage_line);
+			prev_line = line;
+		}
+		task->count++;
+
+		geany_match_info_free(info);
 	}
+	g_slist_free(matches);
+	task->done = TRUE;
+}
+
 
+static void report_usage_count(gint count, const gchar *original_search_text)
+{
 	if (count == 0) /* no matches were found */
 	{
 		ui_set_statusbar(FALSE, _("No matches found for \"%s\"."), original_search_text);
@@ -2344,43 +3074,300 @@ void search_find_usage(const gchar *search_text, const gchar *original_search_te
 }
 
 
+/* Adds the results of finished tasks to the message window, in document order and
+ * in batches to keep the UI responsive */
+static gboolean show_usage_results(gpointer data)
+{
+	UsageSearch *search = data;
+	guint rows = 0;
+
+	while (search->next_task < search->tasks->len && rows < USAGE_ROWS_PER_BATCH)
+	{
+		UsageTask *task = g_ptr_array_index(search->tasks, search->next_task);
+		GeanyDocument *doc;
+
+		if (! g_atomic_int_get(&task->done))
+			return G_SOURCE_CONTINUE;
+
+		/* skip documents closed meanwhile */
+		doc = document_find_by_id(task->doc_id);
+		for (; doc && search->next_line < task->lines->len && rows < USAGE_ROWS_PER_BATCH; rows++)
+		{
+			UsageLine *usage_line = &g_array_index(task->lines, UsageLine, search->next_line++);
+			gchar *buffer = g_strndup(task->text + usage_line->start, usage_line->end - usage_line->start);
+
+			msgwin_msg_add(COLOR_BLACK, usage_line->line + 1, doc,
+				"%s:%d: %s", task->short_file_name, usage_line->line + 1, g_strstrip(buffer));
+			g_free(buffer);
+		}
+		if (doc && search->next_line < task->lines->len)
+			break;
+
+		if (doc)
+			search->count += task->count;
+		search->next_task++;
+		search->next_line = 0;
+	}
+
+	if (search->next_task < search->tasks->len)
+		return G_SOURCE_CONTINUE;
+
+	report_usage_count(search->count, search->original_text);
+	search->source_id = 0;
+	usage_search = NULL;
+	usage_search_unref(search);
+	return G_SOURCE_REMOVE;
+}
+
+
+/* Stops a running session-wide Find Usage, keeping the results shown so far */
+void search_find_usage_cancel(void)
+{
+	if (! usage_search)
+		return;
+
+	g_atomic_int_set(&usage_search->cancelled, TRUE);
+	g_source_remove(usage_search->source_id);
+	usage_search_unref(usage_search);
+	usage_search = NULL;
+}
+
+
+static void get_char_classes(ScintillaObject *sci, guint8 *classes, gsize n_classes)
+{
+	static const struct
+	{
+		gint message;
+		guint8 char_class;
+	}
+	getters[] = {
+		{ SCI_GETPUNCTUATIONCHARS, CHAR_CLASS_PUNCTUATION },
+		{ SCI_GETWHITESPACECHARS, CHAR_CLASS_SPACE },
+		{ SCI_GETWORDCHARS, CHAR_CLASS_WORD }
+	};
+
+	/* newline characters are the only ones the getters don't report */
+	memset(classes, CHAR_CLASS_NEWLINE, n_classes);
+	for (guint i = 0; i < G_N_ELEMENTS(getters); i++)
+	{
+		gint len = (gint) SSM(sci, getters[i].message, 0, 0);
+		gchar *chars = g_malloc(len + 1);
+
+		SSM(sci, getters[i].message, 0, (sptr_t) chars);
+		for (gint j = 0; j < len; j++)
+		{
+			if ((guchar) chars[j] < n_classes)
+				classes[(guchar) chars[j]] = getters[i].char_class;
+		}
+		g_free(chars);
+	}
+}
+
+
+/* Snapshots every open document and searches the snapshots in parallel on usage_pool.
+ * The results are shown by show_usage_results() as they come in. */
+static void find_session_usage(const gchar *search_text, const gchar *original_search_text,
+		GeanyFindFlags flags)
+{
+	UsageSearch *search;
+	GRegex *regex;
+	guint i;
+
+	if (flags & GEANY_FIND_REGEXP)
+		regex = compile_regex(search_text, flags);
+	else
+	{
+		gchar *escaped = g_regex_escape_string(search_text, -1);
+
+		/* Scintilla matches bytes unless ignoring case */
+		regex = g_regex_new(escaped, (flags & GEANY_FIND_MATCHCASE) ? G_REGEX_RAW : G_REGEX_CASELESS,
+			0, NULL);
+		g_free(escaped);
+	}
+	if (! regex)
+		return;
+
+	if (! usage_pool)
+		usage_pool = g_thread_pool_new(usage_task_run, NULL, MAX(g_get_num_processors(), 1), FALSE, NULL);
+
+	search = g_new0(UsageSearch, 1);
+	search->ref_count = 1;
+	search->flags = flags;
+	search->regex = regex;
+	if ((flags & GEANY_FIND_REGEXP) && ! (flags & GEANY_FIND_MULTILINE))
+	{
+		search->buffer_regex = get_buffer_regex(regex);
+		if (search->buffer_regex)
+			g_regex_ref(search->buffer_regex);
+	}
+	search->original_text = g_strdup(original_search_text);
+	search->tasks = g_ptr_array_new();
+
+	foreach_document(i)
+	{
+		ScintillaObject *sci = documents[i]->editor->sci;
+		UsageTask *task = g_new0(UsageTask, 1);
+		const gchar *text = (const gchar *) SSM(sci, SCI_GETCHARACTERPOINTER, 0, 0);
+
+		task->search = search;
+		task->doc_id = documents[i]->id;
+		task->short_file_name = g_path_get_basename(DOC_FILENAME(documents[i]));
+		task->length = sci_get_length(sci);
+		task->text = g_malloc(task->length + 1);
+		memcpy(task->text, text, task->length);
+		task->text[task->length] = '\0';
+		get_char_classes(sci, task->char_classes, G_N_ELEMENTS(task->char_classes));
+		task->lines = g_array_new(FALSE, FALSE, sizeof(UsageLine));
+		g_ptr_array_add(search->tasks, task);
+
+		if (! (flags & (GEANY_FIND_REGEXP | GEANY_FIND_MATCHCASE)) &&
+			! g_utf8_validate(task->text, task->length, NULL))
+		{
+			usage_task_run_sci(task, sci, search_text);
+		}
+	}
+
+	for (i = 0; i < search->tasks->len; i++)
+	{
+		UsageTask *task = g_ptr_array_index(search->tasks, i);
+
+		if (task->done)
+			continue;
+		g_atomic_int_inc(&search->ref_count);
+		g_thread_pool_push(usage_pool, task, NULL);
+	}
+
+	usage_search = search;
+	search->source_id = g_timeout_add(20, show_usage_results, search);
+}
+
+
+void search_find_usage(const gchar *search_text, const gchar *original_search_text,
+		GeanyFindFlags flags, gboolean in_session)
+{
+	GeanyDocument *doc;
+	gint count = 0;
+
+	doc = document_get_current();
+	g_return_if_fail(doc != NULL);
+
+	search_find_usage_cancel();
+
+	if (G_UNLIKELY(EMPTY(search_text)))
+	{
+		utils_beep();
+		return;
+	}
+	reset_msgwin();
+
+	if (in_session)
+	{
+		find_session_usage(search_text, original_search_text, flags);
+		return;
+	}
+
+	/* use current document */
+	count = find_document_usage(doc, search_text, flags);
+	report_usage_count(count, original_search_text);
+}
+
+
+/* Replaces start..end with str, returns the change in length */
+static gint replace_region(ScintillaObject *sci, gint start, gint end, const GString *str)
+{
+	sci_set_target_start(sci, start);
+	sci_set_target_end(sci, end);
+	SSM(sci, SCI_REPLACETARGET, str->len, (sptr_t) str->str);
+	return (gint) str->len - (end - start);
+}
+
+
 /* ttf is updated to include the last match position (ttf->chrg.cpMin) and
  * the new search range end (ttf->chrg.cpMax).
+ * All matches on a line are replaced together, building the new text of the
+ * line region spanning them and replacing it at once rather than editing the
+ * buffer once per match. Regions don't span line breaks between matches, so
+ * line markers and fold state are kept as with separate replacements.
+ * A region is replaced once the next match is found on another line, so the
+ * matches are not collected first.
  * Note: Normally you would call sci_start/end_undo_action() around this call. */
 guint search_replace_range(ScintillaObject *sci, struct Sci_TextToFind *ttf,
 		GeanyFindFlags flags, const gchar *replace_text)
 {
 	gint count = 0;
-	gint offset = 0; /* difference between search pos and replace pos */
-	GSList *match, *matches;
+	gint region_start = -1;
+	gint region_end = 0; /* end of the last match in the region */
+	gint line = 0; /* line of region_end */
+	gint last_start = 0; /* where the last replacement starts */
+	GeanyMatchInfo *info;
+	GString *str;
+	gint mask;
 
 	g_return_val_if_fail(sci != NULL && ttf->lpstrText != NULL && replace_text != NULL, 0);
 	if (! *ttf->lpstrText)
 		return 0;
 
-	matches = find_range(sci, flags, ttf);
-	foreach_slist (match, matches)
+	/* Geany and plugins handle text being inserted and deleted, not the notifications
+	 * about changes about to be made or about markers and indicators, so these aren't
+	 * sent for every region */
+	mask = (gint) SSM(sci, SCI_GETMODEVENTMASK, 0, 0);
+	SSM(sci, SCI_SETMODEVENTMASK, mask & (SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT | SC_MOD_CHANGEFOLD), 0);
+
+	str = g_string_new(NULL);
+	while (search_find_text(sci, flags, ttf, &info) != -1)
 	{
-		GeanyMatchInfo *info = match->data;
-		gint replace_len;
+		gint start = info->start;
+		gint end = info->end;
+		const gchar *text;
 
-		info->start += offset;
-		info->end += offset;
+		if (end > ttf->chrg.cpMax)
+		{
+			/* found text is partially out of range */
+			geany_match_info_free(info);
+			break;
+		}
 
-		replace_len = search_replace_match(sci, info, replace_text);
-		offset += replace_len - (info->end - info->start);
-		count ++;
+		if (region_start >= 0 && sci_get_line_from_position(sci, start) != line)
+		{
+			gint delta = replace_region(sci, region_start, region_end, str);
 
-		/* on last match, update the last match/new range end */
-		if (! match->next)
+			start += delta;
+			end += delta;
+			ttf->chrg.cpMax += delta;
+			region_start = -1;
+		}
+		if (region_start < 0)
 		{
-			ttf->chrg.cpMin = info->start;
-			ttf->chrg.cpMax += offset;
+			region_start = region_end = start;
+			g_string_truncate(str, 0);
 		}
 
+		/* Warning: any modification will invalidate 'text' */
+		text = (const gchar *) SSM(sci, SCI_GETRANGEPOINTER, region_end, start - region_end);
+		g_string_append_len(str, text, start - region_end);
+		last_start = region_start + (gint) str->len;
+		append_replacement(str, info, replace_text);
 		geany_match_info_free(info);
+		count ++;
+
+		region_end = end;
+		line = sci_get_line_from_position(sci, end);
+		ttf->chrg.cpMin = end;
+		/* avoid rematching with empty matches like "(?=[a-z])" or "^$".
+		 * note we cannot assume a match will always be empty or not and then break out, since
+		 * matches like "a?(?=b)" will sometimes be empty and sometimes not */
+		if (end == start)
+			ttf->chrg.cpMin ++;
 	}
-	g_slist_free(matches);
+	if (region_start >= 0)
+		ttf->chrg.cpMax += replace_region(sci, region_start, region_end, str);
+	g_string_free(str, TRUE);
+
+	SSM(sci, SCI_SETMODEVENTMASK, mask, 0);
+
+	/* update the last match position */
+	if (count > 0)
+		ttf->chrg.cpMin = last_start;
 
 	return count;
 }
@@ -134,15 +134,21 @@ void search_find_again(gboolean change_direction);
 
 void search_find_usage(const gchar *search_text, const gchar *original_search_text, GeanyFindFlags flags, gboolean in_session);
 
+void search_find_usage_cancel(void);
+
 void search_find_selection(struct GeanyDocument *doc, gboolean search_backwards);
 
 gint search_mark_all(struct GeanyDocument *doc, const gchar *search_text, GeanyFindFlags flags);
 
+void search_mark_all_cancel(struct GeanyDocument *doc);
+
 gint search_replace_match(struct _ScintillaObject *sci, const GeanyMatchInfo *match, const gchar *replace_text);
 
 guint search_replace_range(struct _ScintillaObject *sci, struct Sci_TextToFind *ttf,
 		GeanyFindFlags flags, const gchar *replace_text);
 
+gboolean search_regex_allows_buffer_search(const gchar *pattern);
+
 #endif /* GEANY_PRIVATE */
 
 G_END_DECLS
@@ -94,8 +94,71 @@ static void sidebar_tabs_show_hide(GtkNotebook *notebook, GtkWidget *child,
 								   guint page_num, gpointer data);
 
 
+static void taglist_name_data_func(GtkTreeViewColumn *column, GtkCellRenderer *cell,
+		GtkTreeModel *model, GtkTreeIter *iter, gpointer data)
+{
+	gchar *name = symbols_get_tag_tree_name(data, model, iter);
+
+	g_object_set(cell, "text", name, NULL);
+	g_free(name);
+}
+
+
+static gboolean taglist_search_equal_func(GtkTreeModel *model, gint column, const gchar *key,
+		GtkTreeIter *iter, gpointer data)
+{
+	gchar *name = symbols_get_tag_tree_name(data, model, iter);
+	gboolean match = FALSE;
+
+	if (name)
+	{
+		gchar *name_folded = g_utf8_casefold(name, -1);
+		gchar *key_folded = g_utf8_casefold(key, -1);
+
+		match = g_str_has_prefix(name_folded, key_folded);
+		g_free(key_folded);
+		g_free(name_folded);
+		g_free(name);
+	}
+	return ! match;
+}
+
+
+static gboolean taglist_query_tooltip_cb(GtkWidget *widget, gint x, gint y,
+		gboolean keyboard_tip, GtkTooltip *tooltip, gpointer data)
+{
+	GtkTreeView *tree_view = GTK_TREE_VIEW(widget);
+	GtkTreeModel *model;
+	GtkTreePath *path;
+	GtkTreeIter iter;
+	gchar *text;
+
+	if (! gtk_tree_view_get_tooltip_context(tree_view, &x, &y, keyboard_tip, &model, &path, &iter))
+		return FALSE;
+
+	text = symbols_get_tag_tree_tooltip(data, model, &iter);
+	if (text)
+	{
+		gtk_tooltip_set_text(tooltip, text);
+		gtk_tree_view_set_tooltip_row(tree_view, tooltip, path);
+		g_free(text);
+	}
+	gtk_tree_path_free(path);
+
+	return text != NULL;
+}
+
+
+static gboolean taglist_test_expand_row_cb(GtkTreeView *tree_view, GtkTreeIter *iter,
+		GtkTreePath *path, gpointer data)
+{
+	symbols_expand_tag_tree_row(data, iter);
+	return FALSE;
+}
+
+
 /* the prepare_* functions are document-related, but I think they fit better here than in document.c */
-static void prepare_taglist(GtkWidget *tree, GtkTreeStore *store)
+static void prepare_taglist(GeanyDocument *doc, GtkWidget *tree, GtkTreeStore *store)
 {
 	GtkCellRenderer *text_renderer, *icon_renderer;
 	GtkTreeViewColumn *column;
@@ -110,7 +173,8 @@ static void prepare_taglist(GtkWidget *tree, GtkTreeStore *store)
   	g_object_set(icon_renderer, "xalign", 0.0, NULL);
 
   	gtk_tree_view_column_pack_start(column, text_renderer, TRUE);
-  	gtk_tree_view_column_set_attributes(column, text_renderer, "text", SYMBOLS_COLUMN_NAME, NULL);
+  	/* symbol names are formatted when shown rather than stored for every row */
+  	gtk_tree_view_column_set_cell_data_func(column, text_renderer, taglist_name_data_func, doc, NULL);
   	g_object_set(text_renderer, "yalign", 0.5, NULL);
   	gtk_tree_view_column_set_title(column, _("Symbols"));
 
@@ -126,12 +190,16 @@ static void prepare_taglist(GtkWidget *tree, GtkTreeStore *store)
 		G_CALLBACK(sidebar_button_press_cb), NULL);
 	g_signal_connect(tree, "key-press-event",
 		G_CALLBACK(sidebar_key_press_cb), NULL);
+	g_signal_connect(tree, "test-expand-row",
+		G_CALLBACK(taglist_test_expand_row_cb), doc);
+	gtk_tree_view_set_search_equal_func(GTK_TREE_VIEW(tree), taglist_search_equal_func, doc, NULL);
 
 	gtk_tree_view_set_show_expanders(GTK_TREE_VIEW(tree), interface_prefs.show_symbol_list_expanders);
 	if (! interface_prefs.show_symbol_list_expanders)
 		gtk_tree_view_set_level_indentation(GTK_TREE_VIEW(tree), 10);
 	/* Tooltips */
-	ui_tree_view_set_tooltip_text_column(GTK_TREE_VIEW(tree), SYMBOLS_COLUMN_TOOLTIP);
+	g_signal_connect(tree, "query-tooltip", G_CALLBACK(taglist_query_tooltip_cb), doc);
+	gtk_widget_set_has_tooltip(tree, TRUE);
 
 	/* selection handling */
 	selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(tree));
@@ -215,9 +283,9 @@ void sidebar_update_tag_list(GeanyDocument *doc, gboolean update)
 		if (doc->priv->tag_tree == NULL)
 		{
 			doc->priv->tag_store = gtk_tree_store_new(
-				SYMBOLS_N_COLUMNS, GDK_TYPE_PIXBUF, G_TYPE_STRING, TM_TYPE_TAG, G_TYPE_STRING);
+				SYMBOLS_N_COLUMNS, GDK_TYPE_PIXBUF, G_TYPE_STRING, TM_TYPE_TAG);
 			doc->priv->tag_tree = gtk_tree_view_new();
-			prepare_taglist(doc->priv->tag_tree, doc->priv->tag_store);
+			prepare_taglist(doc, doc->priv->tag_tree, doc->priv->tag_store);
 			gtk_widget_show(doc->priv->tag_tree);
 			g_object_ref((gpointer)doc->priv->tag_tree);	/* to hold it after removing */
 		}
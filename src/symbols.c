@@ -47,6 +47,7 @@
 #include "highlighting.h"
 #include "main.h"
 #include "navqueue.h"
+#include "perflog.h"
 #include "pluginextension.h"
 #include "sciwrappers.h"
 #include "sidebar.h"
@@ -72,6 +73,29 @@ typedef struct
 	gboolean lower   /* input: search only for lines with lower number than @line */;
 } TreeSearchData;
 
+/* A row of a document's symbol tree.
+ * doc->priv->tag_rows is GHashTable<TMTag, GPtrArray<SymbolRow>>, keyed by tag identity
+ * (see tag_equal()), so that the tags of a new parse can be matched to their rows without
+ * walking the tree store.
+ * doc->priv->tag_group_rows is GPtrArray<SymbolRow> of the lazy top level group rows
+ * ("Functions", ...), which have no tag. */
+typedef struct SymbolRow
+{
+	GtkTreeIter	 iter;		/* the tree store's iters persist until the row is removed */
+	TMTag		*tag;		/* the tag shown in the row, referenced by the tree store */
+	TMTag		*new_tag;	/* the tag of the current update matching this row */
+	guint		 serial;	/* serial of the last update which matched this row */
+	gboolean	 removed;
+	/* Rows with many children are lazy: they only get an empty placeholder child until
+	 * they are expanded, and the tags of their children (referenced) are kept in pending */
+	gboolean	 lazy;
+	GtkTreeIter	 placeholder;
+	GList		*pending;
+} SymbolRow;
+
+/* parents with more children than this are collapsed and filled when expanded */
+#define SYMBOLS_LAZY_CHILDREN 500
+
 
 static GPtrArray *top_level_iter_names = NULL;
 
@@ -713,26 +737,6 @@ static void tree_view_expand_to_iter(GtkTreeView *view, GtkTreeIter *iter)
 }
 
 
-/* like gtk_tree_store_remove() but finds the next iter at any level */
-static gboolean tree_store_remove_row(GtkTreeStore *store, GtkTreeIter *iter)
-{
-	GtkTreeIter parent;
-	gboolean has_parent;
-	gboolean cont;
-
-	has_parent = gtk_tree_model_iter_parent(GTK_TREE_MODEL(store), &parent, iter);
-	cont = gtk_tree_store_remove(store, iter);
-	/* if there is no next at this level but there is a parent iter, continue from it */
-	if (! cont && has_parent)
-	{
-		*iter = parent;
-		cont = ui_tree_model_iter_any_next(GTK_TREE_MODEL(store), iter, FALSE);
-	}
-
-	return cont;
-}
-
-
 static gint tree_search_func(gconstpointer key, gpointer user_data)
 {
 	TreeSearchData *data = user_data;
@@ -767,19 +771,13 @@ static gint tree_cmp(gconstpointer a, gconstpointer b, gpointer user_data)
 }
 
 
-static void parents_table_tree_value_free(gpointer data)
-{
-	g_slice_free(GtkTreeIter, data);
-}
-
-
-/* adds a new element in the parent table if its key is known. */
-static void update_parents_table(GHashTable *table, const TMTag *tag, const GtkTreeIter *iter)
+/* gets the name children of @tag have as their scope (see get_parent_name()).
+ * @name_free is set to the string to free after use, if any. */
+static const gchar *get_qualified_name(const TMTag *tag, gchar **name_free)
 {
 	const gchar *name;
-	gchar *name_free = NULL;
-	GTree *tree;
 
+	*name_free = NULL;
 	if (EMPTY(tag->scope))
 	{
 		/* simple case, just use the tag name */
@@ -797,29 +795,41 @@ static void update_parents_table(GHashTable *table, const TMTag *tag, const GtkT
 	else
 	{
 		/* build the fully qualified scope as get_parent_name() would return it for a child tag */
-		name_free = g_strconcat(tag->scope, tm_parser_scope_separator(tag->lang), tag->name, NULL);
-		name = name_free;
+		*name_free = g_strconcat(tag->scope, tm_parser_scope_separator(tag->lang), tag->name, NULL);
+		name = *name_free;
 	}
+	return name;
+}
+
+
+/* adds a new element in the parent table if its key is known.
+ * @row is the row of @tag, or of its lazy ancestor if @tag has no row yet. */
+static void update_parents_table(GHashTable *table, const TMTag *tag, SymbolRow *row)
+{
+	const gchar *name;
+	gchar *name_free;
+	GTree *tree;
 
+	name = get_qualified_name(tag, &name_free);
 	if (name && g_hash_table_lookup_extended(table, name, NULL, (gpointer *) &tree))
 	{
 		if (!tree)
 		{
-			tree = g_tree_new_full(tree_cmp, NULL, NULL, parents_table_tree_value_free);
+			tree = g_tree_new_full(tree_cmp, NULL, NULL, NULL);
 			g_hash_table_insert(table, name_free ? name_free : g_strdup(name), tree);
 			name_free = NULL;
 		}
 
-		g_tree_insert(tree, GINT_TO_POINTER(tag->line), g_slice_dup(GtkTreeIter, iter));
+		g_tree_insert(tree, GINT_TO_POINTER(tag->line), row);
 	}
 
 	g_free(name_free);
 }
 
 
-static GtkTreeIter *parents_table_lookup(GHashTable *table, const gchar *name, guint line)
+static SymbolRow *parents_table_lookup(GHashTable *table, const gchar *name, guint line)
 {
-	GtkTreeIter *parent_search = NULL;
+	SymbolRow *parent_search = NULL;
 	GTree *tree;
 
 	tree = g_hash_table_lookup(table, name);
@@ -845,259 +855,449 @@ static void parents_table_value_free(gpointer data)
 }
 
 
-/* inserts a @data in @table on key @tag.
- * previous data is not overwritten if the key is duplicated, but rather the
- * two values are kept in a list
- *
- * table is: GHashTable<TMTag, GTree<line_num, GList<GList<TMTag>>>> */
-static void tags_table_insert(GHashTable *table, TMTag *tag, GList *data)
+static guint tag_rows_serial = 0;
+
+
+static void symbol_row_free(gpointer data)
+{
+	SymbolRow *row = data;
+
+	g_list_free_full(row->pending, (GDestroyNotify) tm_tag_unref);
+	g_free(row);
+}
+
+
+static GHashTable *tag_rows_new(void)
 {
-	GTree *tree = g_hash_table_lookup(table, tag);
-	if (!tree)
+	return g_hash_table_new_full(tag_hash, tag_equal,
+		(GDestroyNotify) tm_tag_unref, (GDestroyNotify) g_ptr_array_unref);
+}
+
+
+static SymbolRow *tag_rows_insert(GHashTable *table, TMTag *tag, const GtkTreeIter *iter)
+{
+	GPtrArray *rows = g_hash_table_lookup(table, tag);
+	SymbolRow *row = g_new0(SymbolRow, 1);
+
+	if (!rows)
 	{
-		tree = g_tree_new_full(tree_cmp, NULL, NULL, NULL);
-		g_hash_table_insert(table, tag, tree);
+		rows = g_ptr_array_new_with_free_func(symbol_row_free);
+		g_hash_table_insert(table, tm_tag_ref(tag), rows);
 	}
-	GList *list = g_tree_lookup(tree, GINT_TO_POINTER(tag->line));
-	list = g_list_prepend(list, data);
-	g_tree_insert(tree, GINT_TO_POINTER(tag->line), list);
+	row->iter = *iter;
+	row->tag = tag;
+	row->serial = tag_rows_serial;
+	g_ptr_array_add(rows, row);
+	return row;
+}
+
+
+static gulong line_distance(const TMTag *a, const TMTag *b)
+{
+	return a->line > b->line ? a->line - b->line : b->line - a->line;
 }
 
 
-/* looks up the entry in @table that best matches @tag.
+/* finds the row for @tag not matched yet in this update.
  * if there is more than one candidate, the one that has closest line position to @tag is chosen */
-static GList *tags_table_lookup(GHashTable *table, TMTag *tag)
+static SymbolRow *tag_rows_match(GHashTable *table, TMTag *tag)
 {
-	TreeSearchData user_data = {-1, tag->line, FALSE};
-	GTree *tree = g_hash_table_lookup(table, tag);
+	GPtrArray *rows = g_hash_table_lookup(table, tag);
+	SymbolRow *row, *best = NULL;
+	guint i;
 
-	if (tree)
+	if (!rows)
+		return NULL;
+
+	foreach_ptr_array(row, i, rows)
 	{
-		GList *list;
+		if (row->serial == tag_rows_serial)
+			continue;
+		if (!best || line_distance(row->tag, tag) < line_distance(best->tag, tag))
+			best = row;
+	}
+	return best;
+}
 
-		g_tree_search(tree, (GCompareFunc)tree_search_func, &user_data);
-		list = g_tree_lookup(tree, GINT_TO_POINTER(user_data.found_line));
-		/* return the first value in the list - we don't care which of the
-		 * tags with identical names defined on the same line we get */
-		if (list)
-			return list->data;
+
+/* finds the row holding exactly @tag */
+static SymbolRow *tag_rows_lookup(GHashTable *table, TMTag *tag)
+{
+	GPtrArray *rows = g_hash_table_lookup(table, tag);
+	SymbolRow *row;
+	guint i;
+
+	if (rows)
+	{
+		foreach_ptr_array(row, i, rows)
+		{
+			if (row->tag == tag)
+				return row;
+		}
 	}
 	return NULL;
 }
 
 
-/* removes the element at @tag from @table.
- * @tag must be the exact pointer used at insertion time */
-static void tags_table_remove(GHashTable *table, TMTag *tag)
+/* finds the lazy group row at @iter, the iters of a GtkTreeStore persist and
+ * user_data identifies the row */
+static SymbolRow *group_rows_lookup(GeanyDocument *doc, const GtkTreeIter *iter)
 {
-	GTree *tree = g_hash_table_lookup(table, tag);
-	if (tree)
+	SymbolRow *row;
+	guint i;
+
+	foreach_ptr_array(row, i, doc->priv->tag_group_rows)
+	{
+		if (row->lazy && row->iter.user_data == iter->user_data)
+			return row;
+	}
+	return NULL;
+}
+
+
+/* makes the empty group rows for which @count tags are added lazy */
+static void group_rows_add(GeanyDocument *doc, const guint *count)
+{
+	GtkTreeStore *store = doc->priv->tag_store;
+	guint i;
+
+	for (i = 0; i < MAX_SYMBOL_TYPES; i++)
+	{
+		SymbolRow *row;
+
+		if (count[i] <= SYMBOLS_LAZY_CHILDREN || tv_iters[i].stamp == -1 ||
+			gtk_tree_model_iter_has_child(GTK_TREE_MODEL(store), &tv_iters[i]))
+			continue;
+
+		row = g_new0(SymbolRow, 1);
+		row->iter = tv_iters[i];
+		row->lazy = TRUE;
+		gtk_tree_store_append(store, &row->placeholder, &row->iter);
+		g_ptr_array_add(doc->priv->tag_group_rows, row);
+	}
+}
+
+
+/* removes the placeholder of lazy group rows which have no tags left, so that they are
+ * hidden like other empty groups */
+static void group_rows_purge(GeanyDocument *doc)
+{
+	GPtrArray *rows = doc->priv->tag_group_rows;
+	guint i = 0;
+
+	while (i < rows->len)
 	{
-		GList *list = g_tree_lookup(tree, GINT_TO_POINTER(tag->line));
-		if (list)
+		SymbolRow *row = rows->pdata[i];
+
+		if (! row->pending)
 		{
-			GList *node;
-			/* should always be the first element as we returned the first one in
-			 * tags_table_lookup() */
-			foreach_list(node, list)
-			{
-				if (((GList *) node->data)->data == tag)
-					break;
-			}
-			list = g_list_delete_link(list, node);
-			if (!list)
-				g_tree_remove(tree, GINT_TO_POINTER(tag->line));
-			else
-				g_tree_insert(tree, GINT_TO_POINTER(tag->line), list);
+			gtk_tree_store_remove(doc->priv->tag_store, &row->placeholder);
+			g_ptr_array_remove_index_fast(rows, i);
 		}
+		else
+			i++;
 	}
 }
 
 
-static gboolean tags_table_tree_value_free(gpointer key, gpointer value, gpointer data)
+/* marks the rows below @parent as removed, as removing @parent from the tree store removes
+ * them as well. The tags of the ones still existing are added to @readd. */
+static void tag_rows_remove_children(GtkTreeStore *store, GHashTable *table,
+		GtkTreeIter *parent, GList **readd)
 {
-	GList *list = value;
-	g_list_free(list);
-	return FALSE;
+	GtkTreeModel *model = GTK_TREE_MODEL(store);
+	GtkTreeIter iter;
+	gboolean cont;
+
+	cont = gtk_tree_model_iter_children(model, &iter, parent);
+	while (cont)
+	{
+		SymbolRow *row = NULL;
+		TMTag *tag;
+
+		gtk_tree_model_get(model, &iter, SYMBOLS_COLUMN_TAG, &tag, -1);
+		if (tag)
+		{
+			row = tag_rows_lookup(table, tag);
+			tm_tag_unref(tag);
+		}
+		if (row && !row->removed)
+		{
+			if (row->serial == tag_rows_serial)
+				*readd = g_list_prepend(*readd, row->new_tag);
+			row->removed = TRUE;
+		}
+		tag_rows_remove_children(store, table, &iter, readd);
+		cont = gtk_tree_model_iter_next(model, &iter);
+	}
 }
 
 
-static void tags_table_value_free(gpointer data)
+static gboolean tag_rows_purge_cb(gpointer key, gpointer value, gpointer data)
 {
-	GTree *tree = data;
-	if (tree)
+	GPtrArray *rows = value;
+	guint i = 0;
+
+	while (i < rows->len)
 	{
-		/* free any leftover elements.  note that we can't register a value_free_func when
-		 * creating the tree because we only want to free it when destroying the tree,
-		 * not when inserting a duplicate (we handle this manually) */
-		g_tree_foreach(tree, tags_table_tree_value_free, NULL);
-		g_tree_destroy(tree);
+		SymbolRow *row = rows->pdata[i];
+
+		if (row->removed)
+			g_ptr_array_remove_index_fast(rows, i);
+		else
+			i++;
 	}
+	return rows->len == 0;
 }
 
 
 /*
- * Updates the tag tree for a document with the tags in *list.
+ * Adds rows for @tags to the tag tree of a document.
  * @param doc a document
- * @param tags a pointer to a GList* holding the tags to add/update.  This
- *             list may be updated, removing updated elements.
- *
- * The update is done in two passes:
- * 1) walking the current tree, update tags that still exist and remove the
- *    obsolescent ones;
- * 2) walking the remaining (non updated) tags, adds them in the list.
+ * @param tags the tags to add, sorted so that parents come before their children.
+ * @param expand_new whether to expand the parents which had no children yet.
  *
- * For better performances, we use 2 hash tables:
- * - one containing all the tags for lookup in the first pass (actually stores a
- *   reference in the tags list for removing it efficiently), avoiding list search
- *   on each tag;
- * - the other holding "tag-name":row references for tags having children, used to
- *   lookup for a parent in both passes, avoiding tree traversal.
+ * Parents are looked up in a "tag-name":row table holding the rows of tags having
+ * children, built only for the names of the new tags' parents.
+ * Rows getting more than SYMBOLS_LAZY_CHILDREN children are made lazy, the children
+ * are only added by symbols_expand_tag_tree_row(). So are empty group rows getting more
+ * than SYMBOLS_LAZY_CHILDREN tags without a parent.
  */
-static void update_tree_tags(GeanyDocument *doc, GList **tags)
+static void add_tree_tags(GeanyDocument *doc, GList *tags, gboolean expand_new)
 {
 	GtkTreeStore *store = doc->priv->tag_store;
 	GtkTreeModel *model = GTK_TREE_MODEL(store);
 	GHashTable *parents_table;
-	GHashTable *tags_table;
+	GHashTable *children_count;
+	guint group_count[MAX_SYMBOL_TYPES] = { 0 };
 	GtkTreeIter iter;
-	gboolean cont;
 	GList *item;
 
-	/* Build hash tables holding tags and parents */
-	/* parent table is GHashTable<tag_name, GTree<line_num, GtkTreeIter>>
+	/* parent table is GHashTable<tag_name, GTree<line_num, SymbolRow>>
 	 * where tag_name might be a fully qualified name (with scope) if the language
 	 * parser reports scope properly (see tm_parser_has_full_scope()). */
 	parents_table = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, parents_table_value_free);
-	/* tags table is another representation of the @tags list,
-	 * GHashTable<TMTag, GTree<line_num, GList<GList<TMTag>>>> */
-	tags_table = g_hash_table_new_full(tag_hash, tag_equal, NULL, tags_table_value_free);
-	foreach_list(item, *tags)
+	/* GHashTable<tag_name, guint>, the keys are owned by the tags */
+	children_count = g_hash_table_new(g_str_hash, g_str_equal);
+	foreach_list(item, tags)
 	{
-		TMTag *tag = item->data;
-		const gchar *parent_name;
-
-		tags_table_insert(tags_table, tag, item);
+		const TMTag *tag = item->data;
+		const gchar *parent_name = get_parent_name(tag);
 
-		parent_name = get_parent_name(tag);
 		if (parent_name)
+		{
+			guint count = GPOINTER_TO_UINT(g_hash_table_lookup(children_count, parent_name));
+
 			g_hash_table_insert(parents_table, g_strdup(parent_name), NULL);
+			g_hash_table_insert(children_count, (gpointer) parent_name, GUINT_TO_POINTER(count + 1));
+		}
+		else
+		{
+			GtkTreeIter *group = get_tag_type_iter(tag->lang, tag->type);
+
+			if (group)
+				group_count[ui_prefs.symbols_group_by_type ? group - tv_iters : 0]++;
+		}
 	}
+	group_rows_add(doc, group_count);
+	/* the parents might already be in the tree */
+	if (g_hash_table_size(parents_table) > 0)
+	{
+		GHashTableIter table_iter;
+		gpointer value;
 
-	/* First pass, update existing rows or delete them.
-	 * It is OK to delete them since we walk top down so we would remove
-	 * parents before checking for their children, thus never implicitly
-	 * deleting an updated child */
-	cont = gtk_tree_model_get_iter_first(model, &iter);
-	while (cont)
+		g_hash_table_iter_init(&table_iter, doc->priv->tag_rows);
+		while (g_hash_table_iter_next(&table_iter, NULL, &value))
+		{
+			GPtrArray *rows = value;
+			SymbolRow *row;
+			guint i;
+
+			foreach_ptr_array(row, i, rows)
+				update_parents_table(parents_table, row->tag, row);
+		}
+	}
+
+	foreach_list (item, tags)
 	{
-		TMTag *tag;
+		TMTag *tag = item->data;
+		GtkTreeIter *parent, *parent_group;
+		SymbolRow *row;
+		gboolean expand;
+		const gchar *parent_name;
+		const gchar *name;
+		gchar *name_free;
+		GdkPixbuf *icon;
 
-		gtk_tree_model_get(model, &iter, SYMBOLS_COLUMN_TAG, &tag, -1);
-		if (! tag) /* most probably a toplevel, skip it */
-			cont = ui_tree_model_iter_any_next(model, &iter, TRUE);
-		else
+		parent_group = get_tag_type_iter(tag->lang, tag->type);
+		if (! parent_group)
+			continue;
+
+		/* tv_iters[0] is reserved for the "Symbols" group */
+		parent = ui_prefs.symbols_group_by_type ? parent_group : &tv_iters[0];
+		parent_name = get_parent_name(tag);
+		if (parent_name)
 		{
-			GList *found_item;
+			SymbolRow *parent_search = parents_table_lookup(parents_table, parent_name, tag->line);
 
-			found_item = tags_table_lookup(tags_table, tag);
-			if (! found_item) /* tag doesn't exist, remove it */
-				cont = tree_store_remove_row(store, &iter);
-			else /* tag still exist, update it */
+			if (parent_search && parent_search->lazy)
 			{
-				const gchar *parent_name;
-				TMTag *found = found_item->data;
+				/* wait for the parent to be expanded, see symbols_expand_tag_tree_row() */
+				parent_search->pending = g_list_prepend(parent_search->pending, tm_tag_ref(tag));
+				update_parents_table(parents_table, tag, parent_search);
+				continue;
+			}
+			if (parent_search)
+				parent = &parent_search->iter;
+		}
+		if (parent == parent_group || parent == &tv_iters[0])
+		{
+			SymbolRow *group_row = group_rows_lookup(doc, parent);
 
-				parent_name = get_parent_name(found);
-				/* if parent is unknown, ignore it */
-				if (parent_name && ! g_hash_table_lookup(parents_table, parent_name))
-					parent_name = NULL;
+			if (group_row)
+			{
+				/* wait for the group to be expanded */
+				group_row->pending = g_list_prepend(group_row->pending, tm_tag_ref(tag));
+				update_parents_table(parents_table, tag, group_row);
+				continue;
+			}
+		}
 
-				if (!tm_tags_equal(tag, found))
-				{
-					const gchar *name;
-					gchar *tooltip;
-
-					/* only update fields that (can) have changed (name that holds line
-					 * number, tooltip, and the tag itself) */
-					name = get_symbol_name(doc, found, parent_name == NULL, TRUE);
-					tooltip = get_symbol_tooltip(doc, found, FALSE);
-					gtk_tree_store_set(store, &iter,
-							SYMBOLS_COLUMN_NAME, name,
-							SYMBOLS_COLUMN_TOOLTIP, tooltip,
-							SYMBOLS_COLUMN_TAG, found,
-							-1);
-					g_free(tooltip);
-				}
+		/* only expand to the iter if the parent was empty, otherwise we let the
+		 * folding as it was before (already expanded, or closed by the user) */
+		expand = expand_new && ! gtk_tree_model_iter_has_child(model, parent);
 
-				update_parents_table(parents_table, found, &iter);
+		/* insert the new element, its name and tooltip are formatted when shown */
+		icon = get_child_icon(store, parent_group);
+		gtk_tree_store_insert_with_values(store, &iter, parent, 0,
+				SYMBOLS_COLUMN_ICON, icon,
+				SYMBOLS_COLUMN_TAG, tag,
+				-1);
+		if (G_LIKELY(icon))
+			g_object_unref(icon);
 
-				/* remove the updated tag from the table and list */
-				tags_table_remove(tags_table, found);
-				*tags = g_list_delete_link(*tags, found_item);
+		row = tag_rows_insert(doc->priv->tag_rows, tag, &iter);
+		update_parents_table(parents_table, tag, row);
 
-				cont = ui_tree_model_iter_any_next(model, &iter, TRUE);
-			}
+		name = get_qualified_name(tag, &name_free);
+		if (name && GPOINTER_TO_UINT(g_hash_table_lookup(children_count, name)) > SYMBOLS_LAZY_CHILDREN)
+		{
+			row->lazy = TRUE;
+			gtk_tree_store_append(store, &row->placeholder, &row->iter);
+		}
+		g_free(name_free);
 
-			tm_tag_unref(tag);
+		if (expand)
+			tree_view_expand_to_iter(GTK_TREE_VIEW(doc->priv->tag_tree), &iter);
+	}
+
+	g_hash_table_destroy(children_count);
+	g_hash_table_destroy(parents_table);
+}
+
+
+/*
+ * Updates the tag tree for a document with the tags in @tags.
+ * @param doc a document
+ * @param tags the current tags, sorted so that parents come before their children.
+ *
+ * Instead of walking the whole tree, the tags are matched to their rows by identity
+ * through doc->priv->tag_rows, so only the rows of changed tags are touched:
+ * 1) rows of tags that still exist are updated if the tag changed (e.g. its line);
+ * 2) rows of tags that disappeared are removed. As this also removes their children,
+ *    the children which still exist are queued to be added back;
+ * 3) the new tags are added (or queued if their parent or group is lazy).
+ */
+static void update_tree_tags(GeanyDocument *doc, GList *tags)
+{
+	GtkTreeStore *store = doc->priv->tag_store;
+	GHashTable *table = doc->priv->tag_rows;
+	GHashTableIter table_iter;
+	gpointer value;
+	GPtrArray *stale;
+	GList *added = NULL;
+	GList *readd = NULL;
+	GList *item;
+	SymbolRow *row;
+	guint i;
+
+	tag_rows_serial++;
+
+	/* the children of lazy rows are unmatched below and queued again */
+	g_hash_table_iter_init(&table_iter, table);
+	while (g_hash_table_iter_next(&table_iter, NULL, &value))
+	{
+		GPtrArray *rows = value;
+
+		foreach_ptr_array(row, i, rows)
+		{
+			g_list_free_full(row->pending, (GDestroyNotify) tm_tag_unref);
+			row->pending = NULL;
 		}
 	}
+	foreach_ptr_array(row, i, doc->priv->tag_group_rows)
+	{
+		g_list_free_full(row->pending, (GDestroyNotify) tm_tag_unref);
+		row->pending = NULL;
+	}
 
-	/* Second pass, now we have a tree cleaned up from invalid rows,
-	 * we simply add new ones */
-	foreach_list (item, *tags)
+	/* First pass, match the tags with the existing rows */
+	foreach_list(item, tags)
 	{
 		TMTag *tag = item->data;
-		GtkTreeIter *parent, *parent_group;
 
-		parent_group = get_tag_type_iter(tag->lang, tag->type);
-		/* tv_iters[0] is reserved for the "Symbols" group */
-		parent = ui_prefs.symbols_group_by_type ? parent_group : &tv_iters[0];
-		if (parent_group)
+		row = tag_rows_match(table, tag);
+		if (! row)
 		{
-			gboolean expand;
-			const gchar *name;
-			const gchar *parent_name;
-			gchar *tooltip;
-			GdkPixbuf *icon = get_child_icon(store, parent_group);
-
-			parent_name = get_parent_name(tag);
-			if (parent_name)
-			{
-				GtkTreeIter *parent_search = parents_table_lookup(parents_table, parent_name, tag->line);
+			added = g_list_prepend(added, tag);
+			continue;
+		}
 
-				if (parent_search)
-					parent = parent_search;
-				else
-					parent_name = NULL;
-			}
+		row->serial = tag_rows_serial;
+		row->new_tag = tag;
+		if (row->tag != tag && !tm_tags_equal(row->tag, tag))
+		{
+			/* the name and tooltip are formatted from the tag when shown */
+			gtk_tree_store_set(store, &row->iter, SYMBOLS_COLUMN_TAG, tag, -1);
+			row->tag = tag;
+		}
+	}
 
-			/* only expand to the iter if the parent was empty, otherwise we let the
-			 * folding as it was before (already expanded, or closed by the user) */
-			expand = ! gtk_tree_model_iter_has_child(model, parent);
-
-			/* insert the new element */
-			name = get_symbol_name(doc, tag, parent_name == NULL, TRUE);
-			tooltip = get_symbol_tooltip(doc, tag, FALSE);
-			gtk_tree_store_insert_with_values(store, &iter, parent, 0,
-					SYMBOLS_COLUMN_NAME, name,
-					SYMBOLS_COLUMN_TOOLTIP, tooltip,
-					SYMBOLS_COLUMN_ICON, icon,
-					SYMBOLS_COLUMN_TAG, tag,
-					-1);
-			g_free(tooltip);
-			if (G_LIKELY(icon))
-				g_object_unref(icon);
-
-			update_parents_table(parents_table, tag, &iter);
-
-			if (expand)
-				tree_view_expand_to_iter(GTK_TREE_VIEW(doc->priv->tag_tree), &iter);
+	/* Second pass, remove the rows of the tags which disappeared */
+	stale = g_ptr_array_new();
+	g_hash_table_iter_init(&table_iter, table);
+	while (g_hash_table_iter_next(&table_iter, NULL, &value))
+	{
+		GPtrArray *rows = value;
+
+		foreach_ptr_array(row, i, rows)
+		{
+			if (row->serial != tag_rows_serial)
+				g_ptr_array_add(stale, row);
 		}
 	}
+	foreach_ptr_array(row, i, stale)
+	{
+		/* already removed together with a stale parent */
+		if (row->removed)
+			continue;
 
-	g_hash_table_destroy(parents_table);
-	g_hash_table_destroy(tags_table);
+		tag_rows_remove_children(store, table, &row->iter, &readd);
+		gtk_tree_store_remove(store, &row->iter);
+		row->removed = TRUE;
+	}
+	if (stale->len > 0)
+		g_hash_table_foreach_remove(table, tag_rows_purge_cb, NULL);
+	g_ptr_array_free(stale, TRUE);
+
+	/* Third pass, add the new tags (keeping parents first) */
+	added = g_list_reverse(added);
+	if (readd)
+		added = g_list_sort(g_list_concat(added, readd), compare_symbol_parent_first);
+	if (added)
+		add_tree_tags(doc, added, TRUE);
+	g_list_free(added);
+	group_rows_purge(doc);
 }
 
 
@@ -1134,6 +1334,51 @@ static gboolean tag_has_missing_parent(const TMTag *tag, GtkTreeStore *store,
 }
 
 
+/* gets the name of a tag row as shown, without the line number, as the parts to
+ * concatenate so that comparing doesn't need to build it. parts[0] is NULL for rows
+ * without a name (the placeholder of a lazy row). */
+static void get_row_name_parts(GtkTreeStore *store, GtkTreeIter *iter, const TMTag *tag,
+		const gchar *parts[4])
+{
+	parts[0] = parts[1] = parts[2] = parts[3] = NULL;
+	if (! tag)
+		return;
+
+	/* see get_symbol_name() */
+	if (tag_has_missing_parent(tag, store, iter) &&
+		strpbrk(tag->scope, GEANY_WORDCHARS) == tag->scope)
+	{
+		parts[0] = tag->scope;
+		parts[1] = tm_parser_scope_separator_printable(tag->lang);
+		parts[2] = tag->name;
+	}
+	else
+		parts[0] = tag->name;
+}
+
+
+/* strcmp() of the concatenated NULL-terminated @a and @b parts */
+static gint compare_row_name_parts(const gchar *const *a, const gchar *const *b)
+{
+	const gchar *pa = *a++;
+	const gchar *pb = *b++;
+
+	for (;;)
+	{
+		while (pa && ! *pa)
+			pa = *a++;
+		while (pb && ! *pb)
+			pb = *b++;
+		if (! pa || ! pb)
+			return (pa != NULL) - (pb != NULL);
+		if (*pa != *pb)
+			return (guchar) *pa - (guchar) *pb;
+		pa++;
+		pb++;
+	}
+}
+
+
 static gint tree_sort_func(GtkTreeModel *model, GtkTreeIter *a, GtkTreeIter *b,
 		gpointer user_data)
 {
@@ -1152,39 +1397,40 @@ static gint tree_sort_func(GtkTreeModel *model, GtkTreeIter *a, GtkTreeIter *b,
 		cmp = sort_by_name ? compare_symbol(tag_a, tag_b) :
 			compare_symbol_lines(tag_a, tag_b);
 	}
-	else
+	/* if a is toplevel, b must be also */
+	else if (gtk_tree_store_iter_depth(GTK_TREE_STORE(model), a) == 0)
 	{
 		gchar *astr, *bstr;
 
 		gtk_tree_model_get(model, a, SYMBOLS_COLUMN_NAME, &astr, -1);
 		gtk_tree_model_get(model, b, SYMBOLS_COLUMN_NAME, &bstr, -1);
+		cmp = compare_top_level_names(astr, bstr);
+		g_free(astr);
+		g_free(bstr);
+	}
+	else
+	{
+		const gchar *aparts[4], *bparts[4];
 
-		/* if a is toplevel, b must be also */
-		if (gtk_tree_store_iter_depth(GTK_TREE_STORE(model), a) == 0)
-		{
-			cmp = compare_top_level_names(astr, bstr);
-		}
+		get_row_name_parts(GTK_TREE_STORE(model), a, tag_a, aparts);
+		get_row_name_parts(GTK_TREE_STORE(model), b, tag_b, bparts);
+
+		/* this is what g_strcmp0() does */
+		if (! aparts[0])
+			cmp = -(bparts[0] != NULL);
+		else if (! bparts[0])
+			cmp = 1;
 		else
 		{
-			/* this is what g_strcmp0() does */
-			if (! astr)
-				cmp = -(astr != bstr);
-			else if (! bstr)
-				cmp = astr != bstr;
-			else
-			{
-				cmp = strcmp(astr, bstr);
-
-				/* sort duplicate 'ScopeName::OverloadedTagName' items by line as well */
-				if (tag_a && tag_b)
-					if (!sort_by_name ||
-						(utils_str_equal(tag_a->name, tag_b->name) &&
-							utils_str_equal(tag_a->scope, tag_b->scope)))
-						cmp = compare_symbol_lines(tag_a, tag_b);
-			}
+			cmp = compare_row_name_parts(aparts, bparts);
+
+			/* sort duplicate 'ScopeName::OverloadedTagName' items by line as well */
+			if (tag_a && tag_b)
+				if (!sort_by_name ||
+					(utils_str_equal(tag_a->name, tag_b->name) &&
+						utils_str_equal(tag_a->scope, tag_b->scope)))
+					cmp = compare_symbol_lines(tag_a, tag_b);
 		}
-		g_free(astr);
-		g_free(bstr);
 	}
 	tm_tag_unref(tag_a);
 	tm_tag_unref(tag_b);
@@ -1195,38 +1441,65 @@ static gint tree_sort_func(GtkTreeModel *model, GtkTreeIter *a, GtkTreeIter *b,
 
 static void sort_tree(GtkTreeStore *store, gboolean sort_by_name)
 {
-	gtk_tree_sortable_set_sort_func(GTK_TREE_SORTABLE(store), SYMBOLS_COLUMN_NAME, tree_sort_func,
+	/* sort on the tag column as the name column is only set for top level items */
+	gtk_tree_sortable_set_sort_func(GTK_TREE_SORTABLE(store), SYMBOLS_COLUMN_TAG, tree_sort_func,
 		GINT_TO_POINTER(sort_by_name), NULL);
 
-	gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE(store), SYMBOLS_COLUMN_NAME, GTK_SORT_ASCENDING);
+	gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE(store), SYMBOLS_COLUMN_TAG, GTK_SORT_ASCENDING);
 }
 
 
-gboolean symbols_recreate_tag_list(GeanyDocument *doc, gint sort_mode)
+/* Empties the symbol tree of @a doc, so that it is rebuilt on the next update. */
+void symbols_clear_tag_list(GeanyDocument *doc)
 {
-	GList *tags;
+	if (doc->priv->tag_store)
+		gtk_tree_store_clear(doc->priv->tag_store);
+	if (doc->priv->tag_rows)
+	{
+		g_hash_table_destroy(doc->priv->tag_rows);
+		doc->priv->tag_rows = NULL;
+	}
+	if (doc->priv->tag_group_rows)
+	{
+		g_ptr_array_free(doc->priv->tag_group_rows, TRUE);
+		doc->priv->tag_group_rows = NULL;
+	}
+}
 
-	g_return_val_if_fail(DOC_VALID(doc), FALSE);
+
+static gboolean recreate_tag_list(GeanyDocument *doc, gint sort_mode)
+{
+	GList *tags;
+	gboolean rebuild;
 
 	tags = get_tag_list(doc, ~(tm_tag_local_var_t | tm_tag_include_t));
 	if (tags == NULL)
 		return FALSE;
 
-	if (doc->priv->symbols_group_by_type != ui_prefs.symbols_group_by_type)
-		gtk_tree_store_clear(doc->priv->tag_store);
-
-	doc->priv->symbols_group_by_type = ui_prefs.symbols_group_by_type;
+	/* the tree is only built from scratch when it is first shown or cleared, or if the
+	 * grouping changed; otherwise only the rows of changed tags are updated */
+	rebuild = doc->priv->tag_rows == NULL ||
+		doc->priv->symbols_group_by_type != ui_prefs.symbols_group_by_type;
+	if (rebuild)
+	{
+		symbols_clear_tag_list(doc);
+		doc->priv->tag_rows = tag_rows_new();
+		doc->priv->tag_group_rows = g_ptr_array_new_with_free_func(symbol_row_free);
 
-	/* FIXME: Not sure why we detached the model here? */
+		/* inserting rows into a sorted model is slow, so sort once the tree is built */
+		gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE(doc->priv->tag_store),
+			GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID, 0);
+	}
 
-	/* disable sorting during update because the code doesn't support correctly
-	 * models that are currently being built */
-	gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE(doc->priv->tag_store), GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID, 0);
+	doc->priv->symbols_group_by_type = ui_prefs.symbols_group_by_type;
 
 	/* add grandparent type iters */
 	add_top_level_items(doc);
 
-	update_tree_tags(doc, &tags);
+	if (rebuild)
+		add_tree_tags(doc, tags, TRUE);
+	else
+		update_tree_tags(doc, tags);
 	g_list_free(tags);
 
 	hide_empty_rows(doc->priv->tag_store);
@@ -1234,13 +1507,102 @@ gboolean symbols_recreate_tag_list(GeanyDocument *doc, gint sort_mode)
 	if (sort_mode == SYMBOLS_SORT_USE_PREVIOUS)
 		sort_mode = doc->priv->symbol_list_sort_mode;
 
-	sort_tree(doc->priv->tag_store, sort_mode == SYMBOLS_SORT_BY_NAME);
+	/* the sorting stays enabled during updates, changed rows are moved into place */
+	if (rebuild || sort_mode != doc->priv->tag_store_sort_mode)
+		sort_tree(doc->priv->tag_store, sort_mode == SYMBOLS_SORT_BY_NAME);
+	doc->priv->tag_store_sort_mode = sort_mode;
 	doc->priv->symbol_list_sort_mode = sort_mode;
 
 	return TRUE;
 }
 
 
+gboolean symbols_recreate_tag_list(GeanyDocument *doc, gint sort_mode)
+{
+	gint64 start;
+	gboolean ret;
+
+	g_return_val_if_fail(DOC_VALID(doc), FALSE);
+
+	start = perf_log_begin();
+	ret = recreate_tag_list(doc, sort_mode);
+	perf_log_end(PERF_STAGE_SYMBOL_LIST, start, doc->id, -1);
+	return ret;
+}
+
+
+/* Gets the name to show for the symbol tree row at @a iter.
+ * Tag rows don't store their name to save memory, so it is formatted on demand. */
+gchar *symbols_get_tag_tree_name(GeanyDocument *doc, GtkTreeModel *model, GtkTreeIter *iter)
+{
+	gchar *name;
+	TMTag *tag;
+
+	gtk_tree_model_get(model, iter, SYMBOLS_COLUMN_TAG, &tag, -1);
+	if (! tag)
+	{
+		gtk_tree_model_get(model, iter, SYMBOLS_COLUMN_NAME, &name, -1);
+		return name;
+	}
+
+	/* the scope is shown for tags not below their parent */
+	name = g_strdup(get_symbol_name(doc, tag,
+		gtk_tree_store_iter_depth(GTK_TREE_STORE(model), iter) == 1, TRUE));
+	tm_tag_unref(tag);
+	return name;
+}
+
+
+/* Gets the tooltip for the symbol tree row at @a iter, or NULL. */
+gchar *symbols_get_tag_tree_tooltip(GeanyDocument *doc, GtkTreeModel *model, GtkTreeIter *iter)
+{
+	gchar *tooltip = NULL;
+	TMTag *tag;
+
+	gtk_tree_model_get(model, iter, SYMBOLS_COLUMN_TAG, &tag, -1);
+	if (tag)
+	{
+		tooltip = get_symbol_tooltip(doc, tag, FALSE);
+		tm_tag_unref(tag);
+	}
+	return tooltip;
+}
+
+
+/* Adds the children of a lazy symbol tree row, to be called before it gets expanded. */
+void symbols_expand_tag_tree_row(GeanyDocument *doc, GtkTreeIter *iter)
+{
+	SymbolRow *row = NULL;
+	GList *pending;
+	TMTag *tag;
+
+	if (! doc->priv->tag_rows)
+		return;
+
+	gtk_tree_model_get(GTK_TREE_MODEL(doc->priv->tag_store), iter, SYMBOLS_COLUMN_TAG, &tag, -1);
+	if (tag)
+	{
+		row = tag_rows_lookup(doc->priv->tag_rows, tag);
+		tm_tag_unref(tag);
+	}
+	else
+		row = group_rows_lookup(doc, iter);
+	if (! row || ! row->lazy)
+		return;
+
+	row->lazy = FALSE;
+	pending = g_list_reverse(row->pending);
+	row->pending = NULL;
+	add_tree_tags(doc, pending, FALSE);
+	g_list_free_full(pending, (GDestroyNotify) tm_tag_unref);
+
+	/* remove the placeholder last, so that the row never appears childless */
+	gtk_tree_store_remove(doc->priv->tag_store, &row->placeholder);
+	if (! tag)
+		g_ptr_array_remove_fast(doc->priv->tag_group_rows, row);
+}
+
+
 /* Detects a global tags filetype from the *.lang.* language extension.
  * Returns NULL if there was no matching TM language. */
 static GeanyFiletype *detect_global_tags_filetype(const gchar *utf8_filename)
@@ -1967,18 +2329,42 @@ static gint get_fold_header_after(ScintillaObject *sci, gint line)
 }
 
 
+static gchar *get_tag_qualified_name(const TMTag *tag)
+{
+	if (tag->scope)
+		return g_strconcat(tag->scope, tm_parser_scope_separator(tag->lang), tag->name, NULL);
+	return g_strdup(tag->name);
+}
+
+
 static gint get_current_tag_name(GeanyDocument *doc, gchar **tagname, TMTagType tag_types)
 {
 	gint line;
 	gint parent;
+	gboolean tags_current;
+	const TMTag *tag;
 
 	line = sci_get_current_line(doc->editor->sci);
+	tags_current = doc->tm_file != NULL && doc->tm_file->tags_array != NULL &&
+		(! doc->changed || editor_prefs.autocompletion_update_freq > 0);
+
+	/* if the parser reported where the tags end, look the line up in the file's scope tree */
+	if (tags_current && tm_source_file_get_scope_tag(doc->tm_file, line + 1, tag_types, &tag))
+	{
+		if (tag)
+		{
+			*tagname = get_tag_qualified_name(tag);
+			return tag->line - 1;
+		}
+		*tagname = g_strdup(_("unknown"));
+		return -1;
+	}
+
 	parent = sci_get_fold_parent(doc->editor->sci, line);
 	/* if we're inside a fold level and we have up-to-date tags, get the function from TM */
-	if (parent >= 0 && doc->tm_file != NULL && doc->tm_file->tags_array != NULL &&
-		(! doc->changed || editor_prefs.autocompletion_update_freq > 0))
+	if (parent >= 0 && tags_current)
 	{
-		const TMTag *tag = tm_get_current_tag(doc->tm_file->tags_array, parent + 1, tag_types);
+		tag = tm_get_current_tag(doc->tm_file->tags_array, parent + 1, tag_types);
 
 		if (tag)
 		{
@@ -1999,12 +2385,7 @@ static gint get_current_tag_name(GeanyDocument *doc, gchar **tagname, TMTagType
 
 			if (line <= last_child)
 			{
-				if (tag->scope)
-					*tagname = g_strconcat(tag->scope,
-							tm_parser_scope_separator(tag->lang), tag->name, NULL);
-				else
-					*tagname = g_strdup(tag->name);
-
+				*tagname = get_tag_qualified_name(tag);
 				return tag_line;
 			}
 		}
@@ -54,6 +54,14 @@ GString *symbols_find_typenames_as_string(TMParserType lang, gboolean global);
 
 gboolean symbols_recreate_tag_list(GeanyDocument *doc, gint sort_mode);
 
+void symbols_clear_tag_list(GeanyDocument *doc);
+
+gchar *symbols_get_tag_tree_name(GeanyDocument *doc, GtkTreeModel *model, GtkTreeIter *iter);
+
+gchar *symbols_get_tag_tree_tooltip(GeanyDocument *doc, GtkTreeModel *model, GtkTreeIter *iter);
+
+void symbols_expand_tag_tree_row(GeanyDocument *doc, GtkTreeIter *iter);
+
 gint symbols_generate_global_tags(gint argc, gchar **argv, gboolean want_preprocess);
 
 void symbols_show_load_tags_dialog(void);
@@ -147,6 +147,9 @@ static gboolean init_tag(TMTag *tag, TMSourceFile *file, const tagEntryInfo *tag
 		tag->flags |= tm_tag_flag_anon_t;
 	tag->kind_letter = kind_letter;
 	tag->line = tag_entry->lineNumber;
+	/* a single-line tag ends on its own line, 0 means the parser didn't report the end */
+	if (getTagEndLine(tag_entry) != 0 && getTagEndLine(tag_entry) >= tag->line)
+		tag->end_line = getTagEndLine(tag_entry);
 	if (NULL != tag_entry->extensionFields.signature)
 		tag->arglist = g_strdup(tag_entry->extensionFields.signature);
 	if ((NULL != tag_entry->extensionFields.scopeName) &&
@@ -470,6 +473,9 @@ void tm_ctags_parse(guchar *buffer, gsize buffer_size,
 		return;
 
 	parseRawBuffer(file_name, buffer, buffer_size, language, source_file);
+	if (getLanguageRescanCount(language) > 0)
+		g_debug("%s: parsed %u more time(s) after a parser failure", file_name,
+			getLanguageRescanCount(language));
 
 	rename_anon_tags(source_file);
 }
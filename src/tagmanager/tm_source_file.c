@@ -36,10 +36,33 @@
 #include "tm_parser.h"
 #include "tm_ctags.h"
 
+#include "general.h"  /* must always come before the rest of ctags headers */
+#include "interval_tree_generic.h"
+
+/* A node of the scope tree, the line range covered by a tag */
+typedef struct
+{
+	struct rb_node rb;
+	unsigned long subtree_last;
+	TMTag *tag;
+} ScopeNode;
+
+#define SCOPE_START(n) ((n)->tag->line)
+#define SCOPE_LAST(n) ((n)->tag->end_line)
+
+INTERVAL_TREE_DEFINE(ScopeNode, rb, unsigned long, subtree_last,
+	SCOPE_START, SCOPE_LAST, static G_GNUC_UNUSED, scope_tree)
+
 typedef struct
 {
 	TMSourceFile public;
 	guint refcount;
+	/* interval tree over the line ranges of the tags, built on demand after each parse */
+	struct rb_root scope_root;
+	ScopeNode *scope_nodes;
+	gboolean scope_valid;
+	TMTagType ranged_types;		/* types of the tags having a line range */
+	TMTagType unranged_types;	/* types of the tags without one */
 } TMSourceFilePriv;
 
 
@@ -71,7 +94,7 @@ enum
 };
 
 
-#define SOURCE_FILE_NEW(S) ((S) = g_slice_new(TMSourceFilePriv))
+#define SOURCE_FILE_NEW(S) ((S) = g_slice_new0(TMSourceFilePriv))
 #define SOURCE_FILE_FREE(S) g_slice_free(TMSourceFilePriv, (TMSourceFilePriv *) S)
 
 static int get_path_max(const char *path)
@@ -569,18 +592,15 @@ gboolean tm_source_file_write_tags_file(const gchar *tags_file, GPtrArray *tags_
 
 	g_return_val_if_fail(tags_array && tags_file, FALSE);
 
-	fp = g_fopen(tags_file, "w");
+	fp = tm_source_file_create_tags_file(tags_file);
 	if (!fp)
 		return FALSE;
 
-	fprintf(fp, "# format=tagmanager\n");
 	for (i = 0; i < tags_array->len; i++)
 	{
 		TMTag *tag = TM_TAG(tags_array->pdata[i]);
 
-		ret = write_tag(tag, fp, tm_tag_attr_type_t
-		  | tm_tag_attr_scope_t | tm_tag_attr_arglist_t | tm_tag_attr_vartype_t
-		  | tm_tag_attr_flags_t);
+		ret = tm_source_file_write_tag(fp, tag, FALSE);
 
 		if (!ret)
 			break;
@@ -590,6 +610,52 @@ gboolean tm_source_file_write_tags_file(const gchar *tags_file, GPtrArray *tags_
 	return ret;
 }
 
+/* Creates a tags file in the format written by tm_source_file_write_tags_file(),
+ to be filled tag by tag using tm_source_file_write_tag(). */
+FILE *tm_source_file_create_tags_file(const gchar *tags_file)
+{
+	FILE *fp = g_fopen(tags_file, "w");
+
+	if (fp)
+		fprintf(fp, "# format=tagmanager\n");
+	return fp;
+}
+
+/* Writes one tag to a file created by tm_source_file_create_tags_file().
+ The line number is not part of global tags files, but it is needed to read back
+ tags in the same order in which tm_tags_sort() sorted them. */
+gboolean tm_source_file_write_tag(FILE *fp, TMTag *tag, gboolean with_line)
+{
+	TMTagAttrType attrs = tm_tag_attr_type_t | tm_tag_attr_scope_t |
+		tm_tag_attr_arglist_t | tm_tag_attr_vartype_t | tm_tag_attr_flags_t;
+
+	if (with_line)
+		attrs |= tm_tag_attr_line_t;
+	return write_tag(tag, fp, attrs);
+}
+
+/* Opens a tags file written by tm_source_file_write_tags_file() or
+ tm_source_file_write_tag() to read it tag by tag using tm_source_file_read_tag(). */
+FILE *tm_source_file_open_tags_file(const gchar *tags_file)
+{
+	gchar buf[BUFSIZ];
+	FILE *fp = g_fopen(tags_file, "r");
+
+	if (fp && (NULL == fgets(buf, BUFSIZ, fp) || !g_str_has_prefix(buf, "# format=tagmanager")))
+	{
+		fclose(fp);
+		fp = NULL;
+	}
+	return fp;
+}
+
+/* Returns the next tag of a file opened with tm_source_file_open_tags_file(),
+ or NULL at its end. */
+TMTag *tm_source_file_read_tag(FILE *fp, TMParserType lang)
+{
+	return new_tag_from_tags_file(NULL, fp, lang, TM_FILE_FORMAT_TAGMANAGER);
+}
+
 
 /* Initializes a TMSourceFile structure from a file name. */
 static gboolean tm_source_file_init(TMSourceFile *source_file, const char *file_name,
@@ -684,6 +750,82 @@ static TMSourceFile *tm_source_file_dup(TMSourceFile *source_file)
 	return source_file;
 }
 
+static void scope_tree_clear(TMSourceFilePriv *priv)
+{
+	g_free(priv->scope_nodes);
+	priv->scope_nodes = NULL;
+	priv->scope_root = RB_ROOT;
+	priv->scope_valid = FALSE;
+}
+
+
+static void scope_tree_build(TMSourceFilePriv *priv)
+{
+	GPtrArray *tags = priv->public.tags_array;
+	guint i, n = 0;
+
+	scope_tree_clear(priv);
+	priv->ranged_types = priv->unranged_types = 0;
+	priv->scope_valid = TRUE;
+	if (!tags || tags->len == 0)
+		return;
+
+	priv->scope_nodes = g_new(ScopeNode, tags->len);
+	for (i = 0; i < tags->len; i++)
+	{
+		TMTag *tag = tags->pdata[i];
+
+		if (tag->end_line != 0)
+		{
+			ScopeNode *node = &priv->scope_nodes[n++];
+
+			memset(&node->rb, 0, sizeof node->rb);
+			node->subtree_last = 0;
+			node->tag = tag;
+			scope_tree_insert(node, &priv->scope_root);
+			priv->ranged_types |= tag->type;
+		}
+		else
+			priv->unranged_types |= tag->type;
+	}
+}
+
+
+/* Finds the innermost tag of @a tag_types whose line range contains @a line.
+ @param source_file The source file.
+ @param line The line, starting from 1.
+ @param tag_types The tag types to consider.
+ @param tag Return location for the tag found, or NULL if @a line is not in any.
+ @return FALSE if the parser didn't report the line range of all tags of
+ @a tag_types, in which case @a tag isn't set and the caller has to guess. */
+gboolean tm_source_file_get_scope_tag(TMSourceFile *source_file, gulong line,
+	TMTagType tag_types, const TMTag **tag)
+{
+	TMSourceFilePriv *priv = (TMSourceFilePriv *) source_file;
+	const TMTag *innermost = NULL;
+	ScopeNode *node;
+
+	g_return_val_if_fail(source_file != NULL, FALSE);
+
+	if (!priv->scope_valid)
+		scope_tree_build(priv);
+
+	if (!(priv->ranged_types & tag_types) || (priv->unranged_types & tag_types))
+		return FALSE;
+
+	for (node = scope_tree_iter_first(&priv->scope_root, line, line); node;
+		 node = scope_tree_iter_next(node, line, line))
+	{
+		if ((node->tag->type & tag_types) &&
+			(!innermost || node->tag->line >= innermost->line))
+			innermost = node->tag;
+	}
+
+	*tag = innermost;
+	return TRUE;
+}
+
+
 /* Destroys the contents of the source file. Note that the tags are owned by the
  source file and are also destroyed when the source file is destroyed. If pointers
  to these tags are used elsewhere, then those tag arrays should be rebuilt.
@@ -695,6 +837,7 @@ static void tm_source_file_destroy(TMSourceFile *source_file)
 #endif
 
 	g_free(source_file->file_name);
+	scope_tree_clear((TMSourceFilePriv *) source_file);
 	tm_tags_array_free(source_file->tags_array, TRUE);
 	source_file->tags_array = NULL;
 }
@@ -747,6 +890,9 @@ gboolean tm_source_file_parse(TMSourceFile *source_file, guchar* text_buf, gsize
 		return FALSE;
 	}
 
+	/* the tags are about to be freed */
+	scope_tree_clear((TMSourceFilePriv *) source_file);
+
 	if (source_file->lang == TM_PARSER_NONE)
 	{
 		tm_tags_array_free(source_file->tags_array, FALSE);
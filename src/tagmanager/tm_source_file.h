@@ -63,10 +63,21 @@ GPtrArray *tm_source_file_read_tags_file(const gchar *tags_file, TMParserType mo
 
 gboolean tm_source_file_write_tags_file(const gchar *tags_file, GPtrArray *tags_array);
 
+FILE *tm_source_file_create_tags_file(const gchar *tags_file);
+
+gboolean tm_source_file_write_tag(FILE *fp, struct TMTag *tag, gboolean with_line);
+
+FILE *tm_source_file_open_tags_file(const gchar *tags_file);
+
+struct TMTag *tm_source_file_read_tag(FILE *fp, TMParserType lang);
+
 gchar tm_source_file_get_tag_impl(const gchar *impl);
 
 gchar tm_source_file_get_tag_access(const gchar *access);
 
+gboolean tm_source_file_get_scope_tag(TMSourceFile *source_file, gulong line,
+	TMTagType tag_types, const struct TMTag **tag);
+
 #endif /* GEANY_PRIVATE */
 
 G_END_DECLS
@@ -218,6 +218,23 @@ static gint tm_tag_compare(gconstpointer ptr1, gconstpointer ptr2, gpointer user
 	return returnval;
 }
 
+/*
+ Compares two tags the way tm_tags_sort() and tm_tags_dedup() do.
+ @param a First tag
+ @param b Second tag
+ @param sort_attributes Attributes to compare (int array terminated by 0)
+ @return A negative value, zero or a positive value as a sorts before, equal to
+ or after b.
+*/
+gint tm_tag_compare_attrs(const TMTag *a, const TMTag *b, TMTagAttrType *sort_attributes)
+{
+	TMSortOptions sort_options;
+
+	sort_options.sort_attrs = sort_attributes;
+	sort_options.partial = FALSE;
+	return tm_tag_compare(&a, &b, &sort_options);
+}
+
 gboolean tm_tags_equal(const TMTag *a, const TMTag *b)
 {
 	if (a == b)
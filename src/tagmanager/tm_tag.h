@@ -110,6 +110,7 @@ typedef struct TMTag
 	char impl; /**< Implementation (e.g. virtual) */
 	TMParserType lang; /* Programming language of the file */
 	gchar kind_letter; /* Kind letter from ctags */
+	gulong end_line; /* Last line of the tag's body, 0 if unknown */
 } TMTag;
 
 /* The GType for a TMTag */
@@ -146,6 +147,8 @@ void tm_tag_unref(TMTag *tag);
 
 TMTag *tm_tag_ref(TMTag *tag);
 
+gint tm_tag_compare_attrs(const TMTag *a, const TMTag *b, TMTagAttrType *sort_attributes);
+
 gboolean tm_tags_equal(const TMTag *a, const TMTag *b);
 
 gboolean tm_tag_is_anon(const TMTag *tag);
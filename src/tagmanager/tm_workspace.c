@@ -32,6 +32,9 @@
 #include "tm_parser.h"
 
 
+/* Maximum number of tags create_global_tags_direct() keeps in memory */
+#define GLOBAL_TAGS_RUN_SIZE 250000
+
 /* when changing, always keep the three sort criteria below in sync */
 static TMTagAttrType workspace_tags_sort_attrs[] =
 {
@@ -81,6 +84,9 @@ static gboolean tm_create_workspace(void)
 	theWorkspace->global_typename_array = g_ptr_array_new();
 	theWorkspace->source_file_map = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
 		free_ptr_array);
+	theWorkspace->typename_counts = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+	/* documents start with serial 0 so they always get the initial typename list */
+	theWorkspace->typename_serial = 1;
 
 	tm_ctags_init();
 	tm_parser_verify_type_mappings();
@@ -101,6 +107,7 @@ void tm_workspace_free(void)
 #endif
 
 	g_hash_table_destroy(theWorkspace->source_file_map);
+	g_hash_table_destroy(theWorkspace->typename_counts);
 	for (i=0; i < theWorkspace->source_files->len; ++i)
 		tm_source_file_free(theWorkspace->source_files->pdata[i]);
 	g_ptr_array_free(theWorkspace->source_files, TRUE);
@@ -146,6 +153,58 @@ static void merge_extracted_tags(GPtrArray **dest, GPtrArray *src, TMTagType tag
 }
 
 
+/* Returns the typename_counts key of @a tag, its name together with its language.
+ * Compatible languages share a key as symbols_find_typenames_as_string() lists the
+ * typenames of all of them. */
+static gchar *typename_count_key(const TMTag *tag)
+{
+	TMParserType lang = tag->lang;
+
+	if (tm_parser_langs_compatible(lang, TM_PARSER_C))
+		lang = TM_PARSER_C;
+	return g_strdup_printf("%d:%s", lang, tag->name);
+}
+
+
+/* Keeps typename_counts in sync with the typename tags of @a tags being added to or
+ * removed from typename_array and bumps typename_serial only if a name appears or
+ * disappears for a language, so users can skip rebuilding the keyword list otherwise. */
+static void update_typename_counts(GPtrArray *tags, gboolean add)
+{
+	guint i;
+
+	for (i = 0; i < tags->len; i++)
+	{
+		TMTag *tag = tags->pdata[i];
+		guint *count;
+		gchar *key;
+
+		if (!(tag->type & TM_GLOBAL_TYPE_MASK) || !tag->name)
+			continue;
+
+		key = typename_count_key(tag);
+		count = g_hash_table_lookup(theWorkspace->typename_counts, key);
+		if (add)
+		{
+			if (!count)
+			{
+				count = g_new0(guint, 1);
+				g_hash_table_insert(theWorkspace->typename_counts, key, count);
+				key = NULL;
+				theWorkspace->typename_serial++;
+			}
+			(*count)++;
+		}
+		else if (count && --(*count) == 0)
+		{
+			g_hash_table_remove(theWorkspace->typename_counts, key);
+			theWorkspace->typename_serial++;
+		}
+		g_free(key);
+	}
+}
+
+
 static void update_source_file(TMSourceFile *source_file, guchar* text_buf,
 	gsize buf_size, gboolean use_buffer, gboolean update_workspace)
 {
@@ -159,6 +218,7 @@ static void update_source_file(TMSourceFile *source_file, guchar* text_buf,
 		 * workspace while they exist and can be scanned */
 		tm_tags_remove_file_tags(source_file, theWorkspace->tags_array);
 		tm_tags_remove_file_tags(source_file, theWorkspace->typename_array);
+		update_typename_counts(source_file->tags_array, FALSE);
 	}
 	tm_source_file_parse(source_file, text_buf, buf_size, use_buffer);
 	tm_tags_sort(source_file->tags_array, file_tags_sort_attrs, FALSE, TRUE);
@@ -170,6 +230,7 @@ static void update_source_file(TMSourceFile *source_file, guchar* text_buf,
 		tm_workspace_merge_tags(&theWorkspace->tags_array, source_file->tags_array);
 
 		merge_extracted_tags(&(theWorkspace->typename_array), source_file->tags_array, TM_GLOBAL_TYPE_MASK);
+		update_typename_counts(source_file->tags_array, TRUE);
 	}
 #ifdef TM_DEBUG
 	else
@@ -257,6 +318,7 @@ void tm_workspace_remove_source_file(TMSourceFile *source_file)
 		{
 			tm_tags_remove_file_tags(source_file, theWorkspace->tags_array);
 			tm_tags_remove_file_tags(source_file, theWorkspace->typename_array);
+			update_typename_counts(source_file->tags_array, FALSE);
 			remove_source_file_map(source_file);
 			g_ptr_array_remove_index_fast(theWorkspace->source_files, i);
 			return;
@@ -306,6 +368,10 @@ static void tm_workspace_update(void)
 
 	g_ptr_array_free(theWorkspace->typename_array, TRUE);
 	theWorkspace->typename_array = tm_tags_extract(theWorkspace->tags_array, TM_GLOBAL_TYPE_MASK);
+
+	g_hash_table_remove_all(theWorkspace->typename_counts);
+	update_typename_counts(theWorkspace->typename_array, TRUE);
+	theWorkspace->typename_serial++;
 }
 
 
@@ -551,36 +617,168 @@ cleanup:
 	return ret;
 }
 
+/* Sorts and dedups TAGS and writes them to a new temporary file added to RUNS */
+static gboolean write_tags_run(GPtrArray *tags, GPtrArray *runs)
+{
+	gchar *run_file = create_temp_file("tmp_XXXXXX.tags");
+	gboolean ret = TRUE;
+	FILE *fp;
+	guint i;
+
+	if (!run_file)
+		return FALSE;
+	g_ptr_array_add(runs, run_file);
+
+	fp = tm_source_file_create_tags_file(run_file);
+	if (!fp)
+		return FALSE;
+
+	tm_tags_sort(tags, global_tags_sort_attrs, TRUE, FALSE);
+	for (i = 0; ret && i < tags->len; i++)
+		ret = tm_source_file_write_tag(fp, tags->pdata[i], TRUE);
+
+	return (fclose(fp) == 0) && ret;
+}
+
+/* K-way merges the sorted RUNS into TAGS_FILE, dropping duplicates the way
+ * tm_tags_sort() does, i.e. keeping the tag from the last run */
+static gboolean merge_tags_runs(GPtrArray *runs, const char *tags_file, TMParserType lang)
+{
+	FILE **inputs = g_new0(FILE *, runs->len);
+	TMTag **heads = g_new0(TMTag *, runs->len);
+	TMTag *pending = NULL;
+	gboolean ret = TRUE;
+	gboolean empty = TRUE;
+	FILE *fp;
+	guint i;
+
+	fp = tm_source_file_create_tags_file(tags_file);
+	if (!fp)
+		ret = FALSE;
+
+	for (i = 0; ret && i < runs->len; i++)
+	{
+		inputs[i] = tm_source_file_open_tags_file(runs->pdata[i]);
+		if (!inputs[i])
+			ret = FALSE;
+		else
+			heads[i] = tm_source_file_read_tag(inputs[i], lang);
+	}
+
+	while (ret)
+	{
+		gint min = -1;
+
+		/* there are few runs, a linear scan is cheap compared to the I/O */
+		for (i = 0; i < runs->len; i++)
+		{
+			if (heads[i] && (min < 0 ||
+				tm_tag_compare_attrs(heads[i], heads[min], global_tags_sort_attrs) < 0))
+				min = i;
+		}
+		if (min < 0)
+			break;
+
+		if (pending &&
+			tm_tag_compare_attrs(pending, heads[min], global_tags_sort_attrs) != 0)
+		{
+			ret = tm_source_file_write_tag(fp, pending, FALSE);
+			empty = FALSE;
+		}
+		if (pending)
+			tm_tag_unref(pending);
+		pending = heads[min];
+		heads[min] = tm_source_file_read_tag(inputs[min], lang);
+	}
+
+	if (pending)
+	{
+		if (ret)
+		{
+			ret = tm_source_file_write_tag(fp, pending, FALSE);
+			empty = FALSE;
+		}
+		tm_tag_unref(pending);
+	}
+
+	for (i = 0; i < runs->len; i++)
+	{
+		if (heads[i])
+			tm_tag_unref(heads[i]);
+		if (inputs[i])
+			fclose(inputs[i]);
+	}
+	g_free(heads);
+	g_free(inputs);
+
+	if (fp && fclose(fp) != 0)
+		ret = FALSE;
+	/* like when not spilling, don't create a tags file without tags */
+	if (empty && fp)
+	{
+		g_unlink(tags_file);
+		ret = FALSE;
+	}
+	return ret;
+}
+
+/* Parses the source files one by one. Once the collected tags exceed
+ * GLOBAL_TAGS_RUN_SIZE, they are sorted, written to a temporary file and
+ * released, and the temporary files are merged at the end, so that the
+ * memory use does not grow with the size of the whole set of sources. */
 static gboolean create_global_tags_direct(GList *source_files, const char *tags_file,
 	TMParserType lang)
 {
 	GList *node;
-	GPtrArray *filtered_tags;
 	GPtrArray *tags = g_ptr_array_new();
+	GPtrArray *runs = g_ptr_array_new_with_free_func(g_free);
 	GSList *tm_source_files = NULL;
-	gboolean ret = FALSE;
+	gboolean ret = TRUE;
+	guint i;
 
-	for (node = source_files; node; node = node->next)
+	for (node = source_files; ret && node; node = node->next)
 	{
 		TMSourceFile *source_file = tm_source_file_new(node->data, tm_source_file_get_lang_name(lang));
 		if (source_file)
 		{
-			guint i;
 			tm_source_files = g_slist_prepend(tm_source_files, source_file);
 			tm_source_file_parse(source_file, NULL, 0, FALSE);
 			for (i = 0; i < source_file->tags_array->len; i++)
-				g_ptr_array_add(tags, source_file->tags_array->pdata[i]);
+			{
+				TMTag *tag = source_file->tags_array->pdata[i];
+
+				if (tag->type & ~(tm_tag_local_var_t | tm_tag_include_t))
+					g_ptr_array_add(tags, tag);
+			}
 		}
-	}
 
-	filtered_tags = tm_tags_extract(tags, ~(tm_tag_local_var_t | tm_tag_include_t));
-	tm_tags_sort(filtered_tags, global_tags_sort_attrs, TRUE, FALSE);
+		if (tags->len >= GLOBAL_TAGS_RUN_SIZE)
+		{
+			ret = write_tags_run(tags, runs);
+			g_ptr_array_set_size(tags, 0);
+			g_slist_free_full(tm_source_files, (GDestroyNotify)tm_source_file_free);
+			tm_source_files = NULL;
+		}
+	}
 
-	if (filtered_tags->len > 0)
-		ret = tm_source_file_write_tags_file(tags_file, filtered_tags);
+	if (ret && runs->len == 0)
+	{
+		/* everything fit in a single run, write it directly */
+		tm_tags_sort(tags, global_tags_sort_attrs, TRUE, FALSE);
+		ret = tags->len > 0 && tm_source_file_write_tags_file(tags_file, tags);
+	}
+	else if (ret)
+	{
+		if (tags->len > 0)
+			ret = write_tags_run(tags, runs);
+		if (ret)
+			ret = merge_tags_runs(runs, tags_file, lang);
+	}
 
+	for (i = 0; i < runs->len; i++)
+		g_unlink(runs->pdata[i]);
+	g_ptr_array_free(runs, TRUE);
 	g_ptr_array_free(tags, TRUE);
-	g_ptr_array_free(filtered_tags, TRUE);
 	g_slist_free_full(tm_source_files, (GDestroyNotify)tm_source_file_free);
 
 	return ret;
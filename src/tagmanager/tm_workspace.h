@@ -33,6 +33,8 @@ typedef struct TMWorkspace
 	GPtrArray *typename_array; /* Typename tags for syntax highlighting (pointers owned by source files) */
 	GPtrArray *global_typename_array; /* Like above for global tags */
 	GHashTable *source_file_map; /* File name -> GPtrArray<TMSourceFile> map to speed up lookups based on file name */
+	GHashTable *typename_counts; /* "lang:name" -> number of tags in typename_array with this name */
+	guint typename_serial; /* Incremented whenever the set of names in typename_array changes */
 } TMWorkspace;
 
 
@@ -0,0 +1,199 @@
+/*
+ *      Copyright 2026 The Geany contributors
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/* Literal search benchmark.
+ *
+ * Usage: bench_findtext [--size=MIB] [--runs=N] [--json]
+ *
+ * Builds a synthetic UTF-8 document of about MIB MiB in a Scintilla widget and
+ * finds every occurrence of a few needles through SCI_FINDTEXT, both with and
+ * without SCFIND_MATCHCASE, i.e. the code path used by Find Next, Mark All and
+ * Find in Document. The document is deterministic so that numbers from
+ * different commits can be compared. */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "sciwrappers.h"
+
+#include "Scintilla.h"
+#include "ScintillaWidget.h"
+
+#include <gtk/gtk.h>
+
+
+typedef struct
+{
+	const gchar *name;
+	const gchar *needle;
+	gint flags;
+} BenchCase;
+
+
+static gint bench_runs = 5;
+static gint bench_size = 32;
+static gboolean bench_json = FALSE;
+
+static GOptionEntry entries[] =
+{
+	{ "size", 's', 0, G_OPTION_ARG_INT, &bench_size, "Size of the document in MiB (default: 32)", "MIB" },
+	{ "runs", 'n', 0, G_OPTION_ARG_INT, &bench_runs, "Search every needle N times (default: 5)", "N" },
+	{ "json", 'j', 0, G_OPTION_ARG_NONE, &bench_json, "Print the results as JSON", NULL },
+	{ NULL, 0, 0, 0, NULL, NULL, NULL }
+};
+
+static const BenchCase cases[] =
+{
+	/* frequent, short */
+	{ "ascii-frequent", "count", 0 },
+	{ "ascii-frequent-case", "count", SCFIND_MATCHCASE },
+	/* rare, so mostly measures scanning */
+	{ "ascii-rare", "widget_NEEDLE", 0 },
+	{ "ascii-rare-case", "Widget_needle", SCFIND_MATCHCASE },
+	/* absent, first byte is a frequent letter */
+	{ "ascii-absent", "total_nothing", 0 },
+	/* non-ASCII first character */
+	{ "utf8", "\xc3\xa9tat", 0 },
+	/* ASCII needle that also matches through case folding of U+212A KELVIN SIGN */
+	{ "utf8-folding", "kelvin", 0 }
+};
+
+
+static gchar *make_document(gsize size)
+{
+	GString *doc = g_string_sized_new(size + 256);
+	guint i = 0;
+
+	while (doc->len < size)
+	{
+		g_string_append_printf(doc,
+			"static int func_%x(struct state *s, int count)\n"
+			"{\n"
+			"\tint total = 0;\n"
+			"\n"
+			"\tfor (int k = 0; k < count; k++)\n"
+			"\t\ttotal += s->count * %u;\n",
+			g_int_hash(&i), i);
+		/* some non-ASCII text in comments */
+		if (i % 8 == 0)
+			g_string_append(doc, "\t/* \xc3\xa9tat de la t\xc3\xa2""che, temp\xc3\xa9rature en \xe2\x84\xaa""elvin */\n");
+		if (i % 1000 == 999)
+			g_string_append(doc, "\t/* Widget_needle */\n");
+		g_string_append(doc, "\treturn total;\n}\n\n");
+		i++;
+	}
+	return g_string_free(doc, FALSE);
+}
+
+
+static guint find_all(ScintillaObject *sci, const BenchCase *bench, gint length)
+{
+	struct Sci_TextToFind ttf;
+	guint matches = 0;
+
+	ttf.lpstrText = bench->needle;
+	ttf.chrg.cpMin = 0;
+	ttf.chrg.cpMax = length;
+	while (sci_find_text(sci, bench->flags, &ttf) >= 0)
+	{
+		matches++;
+		/* step past the match, including empty ones */
+		ttf.chrg.cpMin = MAX(ttf.chrgText.cpMax, ttf.chrgText.cpMin + 1);
+	}
+	return matches;
+}
+
+
+int main(int argc, char **argv)
+{
+	GOptionContext *context;
+	GError *error = NULL;
+	ScintillaObject *sci;
+	GTimer *timer;
+	gchar *text;
+	gint length;
+	guint i;
+
+	context = g_option_context_new("- benchmark SCI_FINDTEXT");
+	g_option_context_add_main_entries(context, entries, NULL);
+	if (! g_option_context_parse(context, &argc, &argv, &error))
+	{
+		g_printerr("%s\n", error->message);
+		return 1;
+	}
+	g_option_context_free(context);
+	if (argc > 1 || bench_runs < 1 || bench_size < 1)
+	{
+		g_printerr("Usage: %s [--size=MIB] [--runs=N] [--json]\n", argv[0]);
+		return 1;
+	}
+
+	gtk_init_check(&argc, &argv);
+
+	sci = SCINTILLA(scintilla_object_new());
+	g_object_ref_sink(sci);
+	sci_set_codepage(sci, SC_CP_UTF8);
+	/* no undo history for the initial text */
+	SSM(sci, SCI_SETUNDOCOLLECTION, FALSE, 0);
+	text = make_document((gsize) bench_size * 1024 * 1024);
+	sci_set_text(sci, text);
+	g_free(text);
+	length = sci_get_length(sci);
+
+	if (bench_json)
+		g_print("{\n\t\"runs\": %d,\n\t\"bytes\": %d,\n\t\"cases\": [\n", bench_runs, length);
+	else
+		g_print("%-20s %10s %10s %10s\n", "case", "matches", "ms", "MB/s");
+
+	timer = g_timer_new();
+	for (i = 0; i < G_N_ELEMENTS(cases); i++)
+	{
+		gdouble seconds = 0;
+		guint matches = 0;
+		gdouble mb_per_s;
+		gint run;
+
+		for (run = 0; run < bench_runs; run++)
+		{
+			g_timer_start(timer);
+			matches = find_all(sci, &cases[i], length);
+			g_timer_stop(timer);
+			seconds += g_timer_elapsed(timer, NULL);
+		}
+		seconds /= bench_runs;
+		mb_per_s = seconds > 0 ? length / (1024.0 * 1024.0) / seconds : 0;
+
+		if (bench_json)
+		{
+			g_print("\t\t{ \"case\": \"%s\", \"matches\": %u, \"seconds\": %.6f, \"mb_per_s\": %.3f }%s\n",
+				cases[i].name, matches, seconds, mb_per_s,
+				i + 1 == G_N_ELEMENTS(cases) ? "" : ",");
+		}
+		else
+			g_print("%-20s %10u %10.2f %10.1f\n", cases[i].name, matches, seconds * 1000, mb_per_s);
+	}
+	g_timer_destroy(timer);
+
+	if (bench_json)
+		g_print("\t]\n}\n");
+
+	g_object_unref(sci);
+
+	return 0;
+}
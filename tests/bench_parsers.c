@@ -0,0 +1,331 @@
+/*
+ *      Copyright 2026 The Geany contributors
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/* Parser throughput benchmark.
+ *
+ * Usage: bench_parsers [--runs=N] [--json] PATH...
+ *
+ * Every file below PATH that maps to a filetype with a tag parser is loaded
+ * into memory once and then parsed N times through tm_source_file_parse(),
+ * i.e. the same code path Geany uses for open documents. Results are
+ * reported per parser; --json prints them in a form that can be diffed
+ * between commits. The RSS column is how much the resident set grew while
+ * running a parser, i.e. the memory it keeps (caches, leaks or heap
+ * fragmentation) as the tags are freed after each file, not its peak usage.
+ *
+ * Filetype detection uses the data directory from $top_srcdir (defaults to
+ * the current directory), so run it from the build tree as the ctags tests do.
+ * Large synthetic inputs can be created with scripts/gen-parser-bench-input.py. */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "app.h"
+#include "filetypes.h"
+#include "main.h"
+#include "tm_source_file.h"
+#include "tm_workspace.h"
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <stdio.h>
+#ifdef G_OS_UNIX
+# include <unistd.h>
+#endif
+
+
+typedef struct
+{
+	gchar *file_name;
+	gchar *contents;
+	gsize length;
+	TMParserType lang;
+} BenchInput;
+
+typedef struct
+{
+	TMParserType lang;
+	guint files;
+	guint64 bytes;
+	guint64 tags;
+	gdouble seconds;
+	glong rss_delta_kb;
+} BenchResult;
+
+
+static gint bench_runs = 5;
+static gboolean bench_json = FALSE;
+
+static GOptionEntry entries[] =
+{
+	{ "runs", 'n', 0, G_OPTION_ARG_INT, &bench_runs, "Parse every file N times (default: 5)", "N" },
+	{ "json", 'j', 0, G_OPTION_ARG_NONE, &bench_json, "Print the results as JSON", NULL },
+	{ NULL, 0, 0, 0, NULL, NULL, NULL }
+};
+
+
+/* Current resident set size in KiB, -1 if unknown (only Linux reports it) */
+static glong get_rss_kb(void)
+{
+	glong rss = -1;
+#ifdef G_OS_UNIX
+	gchar *contents;
+
+	if (g_file_get_contents("/proc/self/statm", &contents, NULL, NULL))
+	{
+		gulong pages;
+
+		if (sscanf(contents, "%*u %lu", &pages) == 1)
+			rss = pages * (sysconf(_SC_PAGESIZE) / 1024);
+		g_free(contents);
+	}
+#endif
+	return rss;
+}
+
+
+static glong rss_delta(glong start, glong end)
+{
+	return start < 0 || end < 0 ? G_MINLONG : end - start;
+}
+
+
+static void collect_inputs(const gchar *path, GPtrArray *inputs)
+{
+	if (g_file_test(path, G_FILE_TEST_IS_DIR))
+	{
+		GDir *dir = g_dir_open(path, 0, NULL);
+		const gchar *name;
+
+		if (! dir)
+			return;
+		while ((name = g_dir_read_name(dir)) != NULL)
+		{
+			gchar *child = g_build_filename(path, name, NULL);
+
+			collect_inputs(child, inputs);
+			g_free(child);
+		}
+		g_dir_close(dir);
+	}
+	else if (g_file_test(path, G_FILE_TEST_IS_REGULAR))
+	{
+		GeanyFiletype *ft;
+		BenchInput *input;
+
+		/* expected results of the ctags tests, not sources */
+		if (g_str_has_suffix(path, ".tags"))
+			return;
+
+		ft = filetypes_detect_from_file(path);
+		if (ft == NULL || ft->lang == TM_PARSER_NONE)
+			return;
+
+		input = g_new0(BenchInput, 1);
+		if (! g_file_get_contents(path, &input->contents, &input->length, NULL))
+		{
+			g_free(input);
+			return;
+		}
+		input->file_name = g_strdup(path);
+		input->lang = ft->lang;
+		g_ptr_array_add(inputs, input);
+	}
+}
+
+
+static void bench_input_free(BenchInput *input)
+{
+	g_free(input->file_name);
+	g_free(input->contents);
+	g_free(input);
+}
+
+
+static gint compare_inputs(gconstpointer a, gconstpointer b)
+{
+	const BenchInput *ia = *((const BenchInput **) a);
+	const BenchInput *ib = *((const BenchInput **) b);
+
+	if (ia->lang != ib->lang)
+		return ia->lang - ib->lang;
+	return g_strcmp0(ia->file_name, ib->file_name);
+}
+
+
+static void bench_input(BenchInput *input, BenchResult *result, GTimer *timer)
+{
+	TMSourceFile *source_file;
+	gint i;
+
+	source_file = tm_source_file_new(input->file_name,
+		tm_source_file_get_lang_name(input->lang));
+	if (! source_file)
+		return;
+
+	for (i = 0; i < bench_runs; i++)
+	{
+		g_timer_start(timer);
+		tm_source_file_parse(source_file, (guchar *) input->contents, input->length, TRUE);
+		g_timer_stop(timer);
+
+		result->seconds += g_timer_elapsed(timer, NULL);
+		result->bytes += input->length;
+		result->tags += source_file->tags_array->len;
+	}
+	result->files++;
+
+	tm_source_file_free(source_file);
+}
+
+
+static gdouble per_second(gdouble amount, gdouble seconds)
+{
+	return seconds > 0 ? amount / seconds : 0;
+}
+
+
+static void print_result(const BenchResult *result, const gchar *name, gboolean last)
+{
+	gdouble mb_per_s = per_second(result->bytes / (1024.0 * 1024.0), result->seconds);
+	gdouble tags_per_s = per_second(result->tags, result->seconds);
+	gchar *rss;
+
+	if (result->rss_delta_kb == G_MINLONG)
+		rss = g_strdup(bench_json ? "null" : "-");
+	else
+		rss = g_strdup_printf("%ld", result->rss_delta_kb);
+
+	if (bench_json)
+	{
+		g_print("\t\t{ \"parser\": \"%s\", \"files\": %u, \"bytes\": %" G_GUINT64_FORMAT
+			", \"tags\": %" G_GUINT64_FORMAT ", \"seconds\": %.6f, \"mb_per_s\": %.3f"
+			", \"tags_per_s\": %.1f, \"rss_delta_kb\": %s }%s\n",
+			name, result->files, result->bytes, result->tags, result->seconds,
+			mb_per_s, tags_per_s, rss, last ? "" : ",");
+	}
+	else
+	{
+		g_print("%-16s %6u %12" G_GUINT64_FORMAT " %10" G_GUINT64_FORMAT " %10.3f %12.1f %10s\n",
+			name, result->files, result->bytes, result->tags, mb_per_s, tags_per_s, rss);
+	}
+	g_free(rss);
+}
+
+
+int main(int argc, char **argv)
+{
+	GOptionContext *context;
+	GError *error = NULL;
+	GPtrArray *inputs;
+	GArray *results;
+	BenchResult total = { TM_PARSER_NONE, 0, 0, 0, 0, 0 };
+	const gchar *top_srcdir;
+	GTimer *timer;
+	glong rss_start, parser_rss_start = -1;
+	guint i;
+
+	context = g_option_context_new("PATH... - benchmark the tag parsers");
+	g_option_context_add_main_entries(context, entries, NULL);
+	if (! g_option_context_parse(context, &argc, &argv, &error))
+	{
+		g_printerr("%s\n", error->message);
+		return 1;
+	}
+	g_option_context_free(context);
+	if (argc < 2 || bench_runs < 1)
+	{
+		g_printerr("Usage: %s [--runs=N] [--json] PATH...\n", argv[0]);
+		return 1;
+	}
+
+	main_init_headless();
+	top_srcdir = g_getenv("top_srcdir");
+	app->datadir = g_build_filename(top_srcdir ? top_srcdir : ".", "data", NULL);
+	/* no user configuration: results must not depend on who runs the benchmark */
+	app->configdir = g_dir_make_tmp("geany-bench-XXXXXX", &error);
+	if (! app->configdir)
+	{
+		g_printerr("%s\n", error->message);
+		return 1;
+	}
+	filetypes_init_types();
+	tm_get_workspace();
+
+	inputs = g_ptr_array_new_with_free_func((GDestroyNotify) bench_input_free);
+	for (i = 1; i < (guint) argc; i++)
+		collect_inputs(argv[i], inputs);
+	g_ptr_array_sort(inputs, compare_inputs);
+
+	timer = g_timer_new();
+	results = g_array_new(FALSE, TRUE, sizeof(BenchResult));
+	rss_start = get_rss_kb();
+	for (i = 0; i < inputs->len; i++)
+	{
+		BenchInput *input = g_ptr_array_index(inputs, i);
+		BenchResult *result;
+
+		if (results->len == 0 ||
+			g_array_index(results, BenchResult, results->len - 1).lang != input->lang)
+		{
+			BenchResult empty = { input->lang, 0, 0, 0, 0, 0 };
+
+			g_array_append_val(results, empty);
+			parser_rss_start = get_rss_kb();
+		}
+		result = &g_array_index(results, BenchResult, results->len - 1);
+		bench_input(input, result, timer);
+		result->rss_delta_kb = rss_delta(parser_rss_start, get_rss_kb());
+	}
+	total.rss_delta_kb = rss_delta(rss_start, get_rss_kb());
+	g_timer_destroy(timer);
+
+	if (bench_json)
+		g_print("{\n\t\"runs\": %d,\n\t\"parsers\": [\n", bench_runs);
+	else
+		g_print("%-16s %6s %12s %10s %10s %12s %10s\n",
+			"parser", "files", "bytes", "tags", "MB/s", "tags/s", "+rss (KiB)");
+
+	for (i = 0; i < results->len; i++)
+	{
+		BenchResult *result = &g_array_index(results, BenchResult, i);
+
+		print_result(result, tm_source_file_get_lang_name(result->lang), i + 1 == results->len);
+		total.files += result->files;
+		total.bytes += result->bytes;
+		total.tags += result->tags;
+		total.seconds += result->seconds;
+	}
+
+	if (bench_json)
+	{
+		g_print("\t],\n\t\"total\":\n");
+		print_result(&total, "total", TRUE);
+		g_print("}\n");
+	}
+	else
+		print_result(&total, "total", TRUE);
+
+	g_array_free(results, TRUE);
+	g_ptr_array_free(inputs, TRUE);
+	g_rmdir(app->configdir);
+
+	return 0;
+}
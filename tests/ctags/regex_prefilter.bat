@@ -0,0 +1,13 @@
+REM lines rejected or accepted by the regex prefilter
+:start
+set alpha=1
+  set beta = 2
+SET GAMMA=3
+echo reset delta=4
+setx epsilon=5
+set
+set zeta
+:end_label
+ :not_a_label
+rem :neither
+set eta=%alpha%& set theta=6
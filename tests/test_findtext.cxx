@@ -0,0 +1,169 @@
+/*
+ *      Copyright 2026 The Geany contributors
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/* Case-insensitive Document::FindText() in UTF-8 documents, which skips ahead to the
+ * bytes that can start a match before comparing, see FindFoldedChar() in Scintilla.
+ * The document is used without a widget, so this runs without a display. */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <set>
+#include <map>
+#include <mutex>
+#include <forward_list>
+#include <optional>
+#include <algorithm>
+#include <memory>
+
+#include "ScintillaTypes.h"
+#include "ILoader.h"
+#include "ILexer.h"
+
+#include "Debugging.h"
+#include "Geometry.h"
+#include "Platform.h"
+#include "CharacterCategoryMap.h"
+#include "Position.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "CellBuffer.h"
+#include "CharClassify.h"
+#include "Decoration.h"
+#include "CaseFolder.h"
+#include "Document.h"
+
+#include <glib.h>
+
+using namespace Scintilla;
+using namespace Scintilla::Internal;
+
+
+struct Match
+{
+	Sci::Position start, end;
+};
+
+/* More than 16 bytes before the first match so it isn't in the first SSE2 block.
+ * The matches are around invalid UTF-8 bytes, and "kelvi" + KELVIN SIGN must not
+ * match "kelvin". */
+static const char document[] =
+	"xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx"
+	"Kelvin \xe2\x84\xaa""ELVIN \xff\xfe""kelvin\xc3""KeLvIn\x80 kelvi\xe2\x84\xaa\n";
+
+static const Match kelvin_matches[] = { { 37, 43 }, { 44, 52 }, { 55, 61 }, { 62, 68 } };
+/* U+212A KELVIN SIGN folds to k */
+static const Match kelvin_sign_matches[] =
+	{ { 37, 38 }, { 44, 47 }, { 55, 56 }, { 62, 63 }, { 70, 71 }, { 75, 78 } };
+
+
+/* set up like ScintillaGTK does it for a UTF-8 document */
+static std::unique_ptr<Document> new_document(void)
+{
+	std::unique_ptr<Document> doc = std::make_unique<Document>(DocumentOption::Default);
+
+	doc->SetDBCSCodePage(CpUtf8);
+	doc->SetCaseFolder(std::make_unique<CaseFolderUnicode>());
+	doc->InsertString(0, document, sizeof(document) - 1);
+	return doc;
+}
+
+
+static void assert_matches(Document *doc, const char *needle,
+		const Match *expected, size_t n_expected)
+{
+	Sci::Position pos = 0;
+	size_t n = 0;
+
+	for (;;)
+	{
+		Sci::Position length = strlen(needle);
+		Sci::Position start = doc->FindText(pos, doc->Length(), needle, FindOption::None, &length);
+
+		if (start < 0)
+			break;
+		g_assert_cmpuint(n, <, n_expected);
+		g_assert_cmpint(start, ==, expected[n].start);
+		g_assert_cmpint(start + length, ==, expected[n].end);
+		n++;
+		pos = start + length;
+	}
+	g_assert_cmpuint(n, ==, n_expected);
+}
+
+
+static void test_findtext_kelvin_sign(void)
+{
+	std::unique_ptr<Document> doc = new_document();
+
+	assert_matches(doc.get(), "kelvin", kelvin_matches, G_N_ELEMENTS(kelvin_matches));
+	assert_matches(doc.get(), "KELVIN", kelvin_matches, G_N_ELEMENTS(kelvin_matches));
+	assert_matches(doc.get(), "\xe2\x84\xaa""elvin", kelvin_matches, G_N_ELEMENTS(kelvin_matches));
+	assert_matches(doc.get(), "\xe2\x84\xaa", kelvin_sign_matches, G_N_ELEMENTS(kelvin_sign_matches));
+}
+
+
+static void test_findtext_invalid_utf8(void)
+{
+	static const Match ff_matches[] = { { 53, 54 } };
+	static const Match x80_matches[] = { { 68, 69 } };
+	std::unique_ptr<Document> doc = new_document();
+
+	/* invalid bytes only match themselves */
+	assert_matches(doc.get(), "\xff", ff_matches, G_N_ELEMENTS(ff_matches));
+	assert_matches(doc.get(), "\x80", x80_matches, G_N_ELEMENTS(x80_matches));
+	/* an invalid lead byte doesn't combine with the next byte into a character */
+	assert_matches(doc.get(), "\xc3\x80", NULL, 0);
+}
+
+
+/* Matches must be found wherever the gap of Scintilla's buffer is, also when it
+ * splits a match or a multi-byte character */
+static void test_findtext_gap(void)
+{
+	std::unique_ptr<Document> doc = new_document();
+	Sci::Position length = doc->Length();
+
+	for (Sci::Position gap = 0; gap <= length; gap++)
+	{
+		/* the gap is left where the buffer was changed last */
+		doc->InsertString(gap, "x", 1);
+		doc->DeleteChars(gap, 1);
+
+		assert_matches(doc.get(), "kelvin", kelvin_matches, G_N_ELEMENTS(kelvin_matches));
+		assert_matches(doc.get(), "\xe2\x84\xaa", kelvin_sign_matches, G_N_ELEMENTS(kelvin_sign_matches));
+	}
+}
+
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/findtext/caseless/kelvin_sign", test_findtext_kelvin_sign);
+	g_test_add_func("/findtext/caseless/invalid_utf8", test_findtext_invalid_utf8);
+	g_test_add_func("/findtext/caseless/gap", test_findtext_gap);
+
+	return g_test_run();
+}
@@ -0,0 +1,131 @@
+/*
+ *      Copyright 2026 The Geany contributors
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along
+ *      with this program; if not, write to the Free Software Foundation, Inc.,
+ *      51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "search.h"
+
+#include <string.h>
+
+#define SEARCH_TEST_ADD(path, func) g_test_add_func("/search/" path, func);
+
+
+/* Returns the first line of text on which regex matches, matching each line on its own
+ * like single-line regex search does, or -1 */
+static gint first_line_match(const gchar *pattern, const gchar *text)
+{
+	GRegex *regex = g_regex_new(pattern, 0, 0, NULL);
+	gchar **lines = g_strsplit(text, "\n", -1);
+	gint ret = -1;
+
+	g_assert_nonnull(regex);
+	for (gint i = 0; lines[i] && ret < 0; i++)
+	{
+		if (g_regex_match(regex, lines[i], 0, NULL))
+			ret = i;
+	}
+	g_strfreev(lines);
+	g_regex_unref(regex);
+	return ret;
+}
+
+
+/* Returns the line on which a match of pattern in the whole text starts, compiled like
+ * the buffer regex of single-line search, or -1 */
+static gint buffer_match_line(const gchar *pattern, const gchar *text)
+{
+	GRegex *regex = g_regex_new(pattern, G_REGEX_MULTILINE | G_REGEX_NEWLINE_ANYCRLF, 0, NULL);
+	GMatchInfo *minfo;
+	gint ret = -1;
+
+	g_assert_nonnull(regex);
+	if (g_regex_match(regex, text, 0, &minfo))
+	{
+		gint start, end;
+
+		g_match_info_fetch_pos(minfo, 0, &start, &end);
+		ret = 0;
+		for (const gchar *p = text; p < text + start; p++)
+		{
+			if (*p == '\n')
+				ret++;
+		}
+	}
+	g_match_info_free(minfo);
+	g_regex_unref(regex);
+	return ret;
+}
+
+
+/* The buffer search must not skip a line which matches on its own */
+static void assert_buffer_search_finds(const gchar *pattern, const gchar *text)
+{
+	gint line = first_line_match(pattern, text);
+
+	g_assert_cmpint(line, >=, 0);
+	if (search_regex_allows_buffer_search(pattern))
+		g_assert_cmpint(buffer_match_line(pattern, text), ==, line);
+}
+
+
+static void test_search_buffer_regex_possessive(void)
+{
+	const gchar *text = "foo  \nbar\n";
+
+	/* \s*+ takes the line end and doesn't give it back for $ */
+	g_assert_cmpint(buffer_match_line("foo\\s*+$", text), !=, 0);
+	g_assert_false(search_regex_allows_buffer_search("foo\\s*+$"));
+	assert_buffer_search_finds("foo\\s*+$", text);
+
+	g_assert_false(search_regex_allows_buffer_search("a++"));
+	g_assert_false(search_regex_allows_buffer_search("a?+"));
+	g_assert_false(search_regex_allows_buffer_search("a{1,3}+"));
+
+	/* backtracking quantifiers are fine */
+	g_assert_true(search_regex_allows_buffer_search("foo\\s*$"));
+	g_assert_true(search_regex_allows_buffer_search("a+b+"));
+	g_assert_true(search_regex_allows_buffer_search("a{1,3}b"));
+	assert_buffer_search_finds("foo\\s*$", text);
+}
+
+
+static void test_search_buffer_regex_atomic(void)
+{
+	const gchar *text = "foo  \nbar\n";
+
+	g_assert_cmpint(buffer_match_line("foo(?>\\s*)$", text), !=, 0);
+	g_assert_false(search_regex_allows_buffer_search("foo(?>\\s*)$"));
+	assert_buffer_search_finds("foo(?>\\s*)$", text);
+
+	g_assert_false(search_regex_allows_buffer_search("foo\\s*(*COMMIT)$"));
+
+	/* other groups and lookarounds are fine */
+	g_assert_true(search_regex_allows_buffer_search("foo(?:\\s*)$"));
+	g_assert_true(search_regex_allows_buffer_search("(?<name>foo)\\s*$"));
+	g_assert_true(search_regex_allows_buffer_search("(?<=f)oo(?=\\s)"));
+	assert_buffer_search_finds("(?<name>foo)(?:\\s*)$", text);
+}
+
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	SEARCH_TEST_ADD("buffer_regex/possessive", test_search_buffer_regex_possessive);
+	SEARCH_TEST_ADD("buffer_regex/atomic", test_search_buffer_regex_atomic);
+
+	return g_test_run();
+}